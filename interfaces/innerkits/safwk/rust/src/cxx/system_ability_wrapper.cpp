@@ -130,10 +130,9 @@ OnDemandReasonExtraData DeserializeOnDemandReasonExtraData(MessageParcel &parcel
         return OnDemandReasonExtraData{};
     }
     rust::vec<rust::string> want;
-    auto map = reason->GetWant();
-    for (auto i = map.begin(); i != map.end(); ++i) {
-        want.push_back(rust::string(i->first.data()));
-        want.push_back(rust::string(i->second.data()));
+    for (const auto& [key, value] : reason->GetWantView()) {
+        want.push_back(rust::string(key.data(), key.size()));
+        want.push_back(rust::string(value.data(), value.size()));
     }
 
     auto res = OnDemandReasonExtraData{
@@ -164,10 +163,9 @@ SystemAbilityOnDemandReason BuildReasonWrapper(const OHOS::SystemAbilityOnDemand
 {
     rust::vec<rust::string> want;
 
-    auto map = reason.GetExtraData().GetWant();
-    for (auto i = map.begin(); i != map.end(); ++i) {
-        want.push_back(rust::string(i->first.data()));
-        want.push_back(rust::string(i->second.data()));
+    for (const auto& [key, value] : reason.GetExtraData().GetWantView()) {
+        want.push_back(rust::string(key.data(), key.size()));
+        want.push_back(rust::string(value.data(), value.size()));
     }
 
     return SystemAbilityOnDemandReason{
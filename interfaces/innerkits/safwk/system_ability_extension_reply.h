@@ -0,0 +1 @@
+../../../services/safwk/include/system_ability_extension_reply.h
\ No newline at end of file
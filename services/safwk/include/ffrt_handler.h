@@ -16,6 +16,7 @@
 #ifndef OHOS_SAFWK_FFRT_HANDLER_H
 #define OHOS_SAFWK_FFRT_HANDLER_H
 
+#include <cstdint>
 #include <map>
 #include <shared_mutex>
 #include <string>
@@ -31,8 +32,13 @@ public:
     void RemoveTask(const std::string& name);
 
 private:
+    // Latest task posted under a name and the FfrtTaskStats id of the name.
+    struct TaskEntry {
+        ffrt::task_handle handle;
+        uint32_t nameId;
+    };
     std::shared_mutex mutex_;
-    std::map<std::string, ffrt::task_handle> taskMap_;
+    std::map<std::string, TaskEntry> taskMap_;
     std::shared_ptr<ffrt::queue> queue_;
 };
 } // namespace OHOS
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FFRT_TASK_STATS_H
+#define FFRT_TASK_STATS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "latency_histogram.h"
+#include "single_instance.h"
+
+namespace OHOS {
+/**
+ * @class FfrtTaskStats.
+ * Always-on statistics of the tasks safwk itself posts through FFRTHandler and SerialTaskPool: listener
+ * notifications, prewarm and the ffrt statistics clear timer. The FFRT tasks of the SAs are not covered, they are
+ * reported by the start and stop collection of FFRT_STAT_CMD_TRANSACTION. Each task name is interned once into an
+ * id with its own latency histogram, and the last RING_SIZE tasks are kept in a ring of (id, start, end) slots.
+ * Recording a task takes no lock and copies no name, so both views can be read at any time.
+ */
+class FfrtTaskStats {
+    DECLARE_SINGLE_INSTANCE(FfrtTaskStats);
+
+public:
+    static constexpr uint32_t RING_SIZE = 256;
+    static constexpr uint32_t MAX_TASK_NAME_NUM = 64;
+    // Id of the tasks whose name came after MAX_TASK_NAME_NUM others, they are kept in the ring only.
+    static constexpr uint32_t INVALID_NAME_ID = MAX_TASK_NAME_NUM;
+    using TaskSummary = std::pair<std::string_view, LatencyHistogram::Summary>;
+
+    // Orders summaries by total time descending and appends the first maxNum of them, one line per task name.
+    static void AppendTaskSummaries(std::vector<TaskSummary>& summaries, size_t maxNum, std::string& result);
+
+    // Returns the id of the task name, interning it on first use.
+    uint32_t GetNameId(const std::string& taskName);
+    // startTime and endTime are in us, as in ffrt_stat.
+    void Record(uint32_t nameId, uint64_t startTime, uint64_t endTime);
+    void Record(const std::string& taskName, uint64_t startTime, uint64_t endTime);
+    // Appends the scope line, one line per task name by total time descending, then the recent tasks, oldest first.
+    void Dump(std::string& result);
+    void Reset();
+
+private:
+    // seq is the index of the task in the slot plus one, 0 while a writer fills the slot.
+    struct RingSlot {
+        std::atomic<uint64_t> seq {0};
+        std::atomic<uint32_t> nameId {INVALID_NAME_ID};
+        std::atomic<uint64_t> startTime {0};
+        std::atomic<uint64_t> endTime {0};
+    };
+    std::string GetName(uint32_t nameId) const;
+
+    std::mutex nameLock_;
+    // Guarded by nameLock_.
+    std::unordered_map<std::string, uint32_t> nameIds_;
+    bool fullReported_ = false;
+    // Filled under nameLock_ before nameNum_ publishes them, never changed afterwards.
+    std::array<std::string, MAX_TASK_NAME_NUM> names_;
+    std::array<std::unique_ptr<LatencyHistogram>, MAX_TASK_NAME_NUM> histograms_;
+    std::atomic<uint32_t> nameNum_ {0};
+    std::array<RingSlot, RING_SIZE> ring_;
+    // Number of tasks ever written to ring_, the next one goes to ringCount_ % RING_SIZE.
+    std::atomic<uint64_t> ringCount_ {0};
+    // ringCount_ at the last Reset, older tasks are no longer dumped.
+    std::atomic<uint64_t> ringBase_ {0};
+};
+} // namespace OHOS
+#endif // FFRT_TASK_STATS_H
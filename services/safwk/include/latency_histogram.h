@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace OHOS {
+/**
+ * @class LatencyHistogram.
+ * Fixed-size log-linear histogram of durations in us. Each power of two is split into SUB_BUCKET_NUM
+ * buckets, so a percentile is off by at most 1/SUB_BUCKET_NUM of its value. Record is lock-free and
+ * may race with GetSummary and Reset, a summary read meanwhile is only approximately consistent.
+ */
+class LatencyHistogram {
+public:
+    static constexpr uint32_t SUB_BUCKET_BITS = 3;
+    static constexpr uint32_t SUB_BUCKET_NUM = 1 << SUB_BUCKET_BITS;
+    // Durations from 2^MAX_EXPONENT us (about 71 minutes) on share the last, overflow bucket.
+    static constexpr uint32_t MAX_EXPONENT = 32;
+    static constexpr uint32_t BUCKET_NUM = (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKET_NUM + 1;
+
+    struct Summary {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+        uint64_t p50 = 0;
+        uint64_t p90 = 0;
+        uint64_t p99 = 0;
+        uint64_t p999 = 0;
+    };
+
+    void Record(uint64_t durationUs);
+    Summary GetSummary() const;
+    void Reset();
+    // Appends "count:.. avg:.. p50:.. p90:.. p99:.. p999:.. max:..", all durations in us.
+    static void FormatSummary(const Summary& summary, std::string& result);
+
+    static uint32_t GetBucketIndex(uint64_t durationUs);
+    // Largest duration counted in the bucket.
+    static uint64_t GetBucketUpperBound(uint32_t index);
+
+private:
+    std::array<std::atomic<uint32_t>, BUCKET_NUM> buckets_ {};
+    std::atomic<uint64_t> sum_ {0};
+    std::atomic<uint64_t> max_ {0};
+};
+} // namespace OHOS
+#endif // LATENCY_HISTOGRAM_H
@@ -18,14 +18,21 @@
 
 #include <string>
 #include <unordered_map>
+#include <cstdint>
 #include <list>
+#include <map>
+#include <set>
 #include <unistd.h>
+#include <array>
+#include <atomic>
 #include <condition_variable>
 #include <shared_mutex>
+#include "latency_histogram.h"
 #include "local_ability_manager_stub.h"
 #include "system_ability.h"
 #include "thread_pool.h"
 #include "parse_util.h"
+#include "sa_lifecycle_command.h"
 #include "single_instance.h"
 #include "system_ability_ondemand_reason.h"
 #include "system_ability_status_change_stub.h"
@@ -33,6 +40,9 @@
 #include "timer.h"
 
 namespace OHOS {
+class FFRTHandler;
+class SerialTaskPool;
+
 // Check all dependencies's availability before the timeout period ended, [200, 60000].
 const int32_t MIN_DEPENDENCY_TIMEOUT = 200;
 const int32_t MAX_DEPENDENCY_TIMEOUT = 60000;
@@ -43,6 +53,13 @@ enum ListenerState {
     NOTIFIED
 };
 
+// Scheduling class of an SA, configured by "priority-class" in the profile. Lower value starts first.
+enum class SaPriorityClass : int32_t {
+    USER_VISIBLE = 0,
+    DEFAULT,
+    BACKGROUND,
+};
+
 class LocalAbilityManager : public LocalAbilityManagerStub {
     DECLARE_SINGLE_INSTANCE_BASE(LocalAbilityManager);
 
@@ -52,10 +69,15 @@ public:
     SystemAbility* GetAbility(int32_t systemAbilityId);
     bool GetRunningStatus(int32_t systemAbilityId);
     bool AddSystemAbilityListener(int32_t systemAbilityId, int32_t listenerSaId);
+    bool AddSystemAbilityListeners(const std::vector<int32_t>& systemAbilityIds, int32_t listenerSaId);
     bool RemoveSystemAbilityListener(int32_t systemAbilityId, int32_t listenerSaId);
     std::vector<int32_t> CheckDependencyStatus(const std::vector<int32_t>& dependSas);
     void StartSystemAbilityTask(SystemAbility* sa);
     bool CheckSystemAbilityManagerReady();
+    int64_t GetSamgrReadyWaitTime() const
+    {
+        return samgrReadyWaitTime_;
+    }
     bool InitSystemAbilityProfiles(const std::string& profilePath, int32_t saId);
     void ClearResource();
     void StartOndemandSystemAbility(int32_t systemAbilityId);
@@ -66,11 +88,21 @@ public:
     bool IdleAbility(int32_t systemAbilityId, const nlohmann::json& idleReason,
         int32_t& delayTime) override;
     bool StopAbility(int32_t systemAbilityId, const std::string& eventStr) override;
+    bool StartAbilityWithReason(int32_t systemAbilityId, SystemAbilityOnDemandReason&& startReason) override;
+    bool StopAbilityWithReason(int32_t systemAbilityId, SystemAbilityOnDemandReason&& stopReason) override;
+    bool ActiveAbilityWithReason(int32_t systemAbilityId, SystemAbilityOnDemandReason& activeReason) override;
+    void BatchLifecycle(std::vector<SaLifecycleCommand>& commands) override;
+    bool IdleAbilityWithReason(int32_t systemAbilityId, SystemAbilityOnDemandReason& idleReason,
+        int32_t& delayTime) override;
     void DoStartSAProcess(const std::string& profilePath, int32_t saId);
+    void SetStartReason(int32_t systemAbilityId, SystemAbilityOnDemandReason&& event);
+    void SetStopReason(int32_t systemAbilityId, SystemAbilityOnDemandReason&& event);
+    // json shims of the typed setters above
     void SetStartReason(int32_t systemAbilityId, const nlohmann::json& event);
     void SetStopReason(int32_t systemAbilityId, const nlohmann::json& event);
-    nlohmann::json GetStartReason(int32_t systemAbilityId);
-    nlohmann::json GetStopReason(int32_t systemAbilityId);
+    SystemAbilityOnDemandReason GetStartReason(int32_t systemAbilityId);
+    std::vector<SystemAbilityOnDemandReason> GetMergedStartReasons(int32_t systemAbilityId);
+    SystemAbilityOnDemandReason GetStopReason(int32_t systemAbilityId);
     SystemAbilityOnDemandReason JsonToOnDemandReason(const nlohmann::json& reasonJson);
     bool SendStrategyToSA(int32_t type, int32_t systemAbilityId, int32_t level, std::string& action) override;
     bool IpcStatCmdProc(int32_t fd, int32_t cmd) override;
@@ -78,6 +110,11 @@ public:
     bool FfrtDumperProc(std::string& result) override;
     int32_t SystemAbilityExtProc(const std::string& extension, int32_t said,
         SystemAbilityExtensionPara* callback, bool isAsync = false) override;
+    int32_t SystemAbilityExtProcAsync(const std::string& extension, int32_t said, MessageParcel& data,
+        const std::shared_ptr<SystemAbilityExtensionReply>& reply) override;
+    bool ListenerStatCmdProc(int32_t fd, int32_t cmd) override;
+    bool LifecycleMetricsCmdProc(int32_t fd, int32_t cmd) override;
+    bool SafwkTaskStatCmdProc(int32_t fd, int32_t cmd) override;
     int32_t ServiceControlCmd(int32_t fd, int32_t systemAbilityId, const std::vector<std::u16string>& args) override;
 
 private:
@@ -93,6 +130,10 @@ private:
     void FindAndNotifyAbilityListeners(int32_t systemAbilityId, const std::string& deviceId, int32_t code);
     void NotifyAbilityListener(int32_t systemAbilityId, int32_t listenerSaId,
         const std::string& deviceId, int32_t code);
+    void PostNotifyAbilityListener(int32_t systemAbilityId, int32_t listenerSaId,
+        const std::string& deviceId, int32_t code);
+    void TimedNotifyAbilityListener(int32_t systemAbilityId, int32_t listenerSaId,
+        const std::string& deviceId, int32_t code, int64_t dueTime);
     void WaitForTasks();
     void StartDependSaTask(SystemAbility* ability);
     class SystemAbilityListener : public SystemAbilityStatusChangeStub {
@@ -121,13 +162,123 @@ private:
     void LimitUnusedTimeout(int32_t saId, int32_t timeout);
     bool GetSaLastRequestTime(int32_t saId, uint64_t& lastRequestTime);
     void StartOnDemandTimer();
+    bool WaitForAbilityAdded(int32_t systemAbilityId);
+    sptr<ISystemAbilityManager> WaitForSystemAbilityManager(int64_t deadline);
+    void RecordStartRequest(int32_t systemAbilityId);
+    void InitSaExtraCfg(const std::string& profilePath);
+    void SchedulePrewarm();
+    std::vector<int32_t> GetPrewarmCandidates();
+    void PrewarmOndemandSystemAbilities();
 
-    std::map<int32_t, SystemAbility*> localAbilityMap_;
-    std::map<uint32_t, std::list<SystemAbility*>> abilityPhaseMap_;
+    // Pending on-demand ops of one SA, requests arriving while its worker runs are merged here.
+    struct OndemandTask {
+        bool running = false;
+        bool startPending = false;
+        bool stopPending = false;
+        std::vector<SystemAbilityOnDemandReason> startReasons;
+        SystemAbilityOnDemandReason stopReason;
+    };
+    OndemandTask& QueueStartLocked(int32_t systemAbilityId, SystemAbilityOnDemandReason&& startReason);
+    OndemandTask& QueueStopLocked(int32_t systemAbilityId, SystemAbilityOnDemandReason&& stopReason);
+    void RunOndemandTaskLocked(int32_t systemAbilityId, OndemandTask& task);
+    void ProcessBatchStart(const std::vector<int32_t>& saIds);
+    void StartBatchGroup(const std::vector<int32_t>& saIds);
+    void LoadBatchLibraries(const std::vector<int32_t>& saIds);
+    void ProcessOndemandTask(int32_t systemAbilityId);
+    void SetMergedStartReasons(int32_t systemAbilityId, std::vector<SystemAbilityOnDemandReason>&& events);
+    SaPriorityClass GetPriorityClass(int32_t systemAbilityId);
+    void UpdateUserVisibleTaskNum(bool isAdd);
+    void YieldToUserVisibleTask(int32_t systemAbilityId);
+
+    // Everything this process keeps about one SA, stored contiguously in saRecords_.
+    struct SaRecord {
+        int32_t saId = 0;
+        // boot phase the SA is queued to start in, phaseSeq keeps the queueing order
+        uint32_t bootPhase = UINT32_MAX;
+        uint32_t phaseSeq = 0;
+        // longtime-unused timeout in ms, 0 if not configured
+        int32_t unusedTimeout = 0;
+        SystemAbility* ability = nullptr;
+        bool hasStartReason = false;
+        SystemAbilityOnDemandReason startReason;
+        SystemAbilityOnDemandReason stopReason;
+        std::vector<SystemAbilityOnDemandReason> mergedStartReasons;
+    };
+    // Listeners of one SA, which usually lives in another process, indexed by listener SA id.
+    struct ListenerRecord {
+        int32_t saId = 0;
+        std::unordered_map<int32_t, ListenerState> listeners;
+    };
+    SaRecord* FindSaRecordLocked(int32_t saId);
+    SaRecord& GetSaRecordLocked(int32_t saId);
+    ListenerRecord* FindListenerRecordLocked(int32_t saId);
+    ListenerRecord& GetListenerRecordLocked(int32_t saId);
+    bool LoadSaLib(int32_t saId);
+    // Dispatch statistics of one listener SA, durations in us.
+    struct ListenerStat {
+        LatencyHistogram dispatch;
+        // From the time a notification was due to the time its callback started.
+        LatencyHistogram queueing;
+        std::atomic<uint64_t> slowCount {0};
+    };
+    std::shared_ptr<ListenerStat> GetListenerStat(int32_t listenerSaId);
+    void DumpListenerStatistics(std::string& result);
+    // Latest pending event and last delivered event of one (SA, listener SA) pair in coalescing mode.
+    struct CoalescedEvent {
+        int32_t pendingCode = 0;
+        int32_t deliveredCode = 0;
+        std::string deviceId;
+        // Sequence of the delivery task posted for the pending event.
+        uint64_t taskSeq = 0;
+    };
+    uint32_t GetListenerCoalesceTime(int32_t listenerSaId);
+    void PostCoalescedEvent(int32_t systemAbilityId, int32_t listenerSaId,
+        const std::string& deviceId, int32_t code, uint32_t coalesceTime);
+    void DeliverCoalescedEvent(int32_t systemAbilityId, int32_t listenerSaId, int64_t dueTime, uint64_t taskSeq);
+    void ClearCoalescedEvent(int32_t systemAbilityId, int32_t listenerSaId);
+    // Drops the coalesced events, pending notifications and statistics of a listener SA that is going away.
+    void ReleaseListener(int32_t listenerSaId);
+    void ClearCoalescedEventLocked(std::map<std::pair<int32_t, int32_t>, CoalescedEvent>::iterator iter);
+    // Returns the entries of checkList whose SA is registered in samgr.
+    std::vector<std::pair<int32_t, bool>> CheckPresentAbilities(const sptr<ISystemAbilityManager>& samgrProxy,
+        const std::vector<std::pair<int32_t, bool>>& checkList);
+    // Marks the listener NOTIFIED on each present SA, returns the SAs it should be notified of.
+    std::vector<int32_t> ClaimListenerNotify(const std::vector<std::pair<int32_t, bool>>& presentList,
+        int32_t listenerSaId);
+    // Subscribes or unsubscribes the SA in samgr as its listener record requires, isSubscribed tells whether
+    // this call made a new subscription. Calls for one SA are serialized by its subscribe lock.
+    bool SyncListenerSubscription(const sptr<ISystemAbilityManager>& samgrProxy, int32_t systemAbilityId,
+        bool& isSubscribed);
+    std::list<SystemAbility*> GetPhaseAbilities(uint32_t bootPhase);
+    std::vector<std::pair<int32_t, int32_t>> GetUnusedCfgs();
+
+    // Immutable snapshot of the registered abilities sorted by SA id, read by GetAbility without locking.
+    struct AbilityRegistry {
+        std::vector<std::pair<int32_t, SystemAbility*>> abilities;
+    };
+    // Slot in which one reader thread pins the snapshot it reads, padded so readers share no cache line.
+    struct alignas(64) RegistryHazard {
+        std::atomic<bool> claimed = false;
+        std::atomic<AbilityRegistry*> registry = nullptr;
+    };
+    static constexpr size_t MAX_REGISTRY_READER_NUM = 64;
+    void PublishAbilityRegistryLocked();
+    RegistryHazard* ClaimRegistryHazard();
+
+    // Sorted by SA id, guarded by localAbilityMapLock_.
+    std::vector<SaRecord> saRecords_;
+    uint32_t phaseSeq_ = 0;
     std::shared_mutex localAbilityMapLock_;
+    // Republished on every ability change in saRecords_, retired snapshots are guarded by localAbilityMapLock_
+    // and freed by a later publish once no reader pins them in registryHazards_.
+    std::atomic<AbilityRegistry*> abilityRegistry_ = nullptr;
+    std::array<RegistryHazard, MAX_REGISTRY_READER_NUM> registryHazards_;
+    std::vector<AbilityRegistry*> retiredRegistries_;
+    // Notified by AddAbility, lets on-demand start wake up as soon as the SA registers itself.
+    std::condition_variable_any abilityAddedCV_;
     sptr<LocalAbilityManager> localAbilityManager_;
-    std::map<int32_t, nlohmann::json> saIdToStartReason_;
-    std::map<int32_t, nlohmann::json> saIdToStopReason_;
+    std::mutex ondemandTaskLock_;
+    std::map<int32_t, OndemandTask> ondemandTaskMap_;
     // Max task number in pool is 20.
     const int32_t MAX_TASK_NUMBER = 20;
     // Check dependent sa status every 50 ms, it equals 50000us.
@@ -135,8 +286,21 @@ private:
 
     std::mutex listenerLock_;
     sptr<ISystemAbilityStatusChange> statusChangeListener_;
-    std::map<int32_t, std::list<std::pair<int32_t, ListenerState>>> localListenerMap_;
-    std::mutex ReasonLock_;
+    // Sorted by listened SA id, guarded by listenerLock_.
+    std::vector<ListenerRecord> listenerRecords_;
+    // SAs subscribed in samgr, guarded by listenerLock_ and changed only under the SA's subscribe lock.
+    std::set<int32_t> subscribedSaIds_;
+    static constexpr size_t SUBSCRIBE_LOCK_NUM = 16;
+    std::array<std::mutex, SUBSCRIBE_LOCK_NUM> subscribeLocks_;
+    // Runs a serial notify queue per listener SA, keyed by the listener SA id.
+    std::unique_ptr<SerialTaskPool> listenerPool_;
+    std::mutex listenerHandlerLock_;
+    // Keyed by (SA, listener SA), guarded by listenerHandlerLock_.
+    std::map<std::pair<int32_t, int32_t>, CoalescedEvent> coalescedEvents_;
+    // Guarded by listenerHandlerLock_.
+    uint64_t coalesceTaskSeq_ = 0;
+    // Guarded by listenerHandlerLock_, an entry is dropped with its listener SA.
+    std::map<int32_t, std::shared_ptr<ListenerStat>> listenerStats_;
     std::shared_ptr<ParseUtil> profileParser_;
 
     std::condition_variable startPhaseCV_;
@@ -144,13 +308,32 @@ private:
     int32_t startTaskNum_ = 0;
     std::u16string procName_;
     int64_t startBegin_ = 0;
+    // Time spent in CheckSystemAbilityManagerReady waiting for samgr, in ms.
+    int64_t samgrReadyWaitTime_ = 0;
 
     // Thread pool used to start system abilities in parallel.
     std::unique_ptr<ThreadPool> initPool_;
     std::unique_ptr<Utils::Timer> idleTimer_;
-    // longtime-unusedtimeout map
-    std::map<int32_t, int32_t> unusedCfgMap_;
     uint32_t ondemandTimer_ = 0;
+
+    // On-demand SAs marked "prewarm" in the profile get their library loaded (not started) when idle.
+    std::mutex prewarmLock_;
+    std::set<int32_t> prewarmCfgSet_;
+    std::map<int32_t, uint32_t> startRequestCount_;
+    int64_t lastOndemandRequestTime_ = 0;
+    bool prewarmPending_ = false;
+    std::shared_ptr<FFRTHandler> prewarmHandler_;
+    std::atomic<int32_t> ondemandTaskNum_ = 0;
+
+    // Guards priorityCfgMap_, which InitSaExtraCfg may fill while starts read it.
+    std::shared_mutex saExtraCfgLock_;
+    std::map<int32_t, SaPriorityClass> priorityCfgMap_;
+    // Listener SAs with "listener-coalesce-ms", value is the coalescing window in ms.
+    std::map<int32_t, uint32_t> coalesceCfgMap_;
+    // Background starts wait while user-visible starts are pending.
+    std::mutex priorityLock_;
+    std::condition_variable userVisibleCV_;
+    int32_t userVisibleTaskNum_ = 0;
 };
 }
 #endif
@@ -17,8 +17,12 @@
 #define LOCAL_ABILITY_MANAGER_DUMPER_H
 
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include "if_local_ability_manager.h"
 #include "ffrt_handler.h"
+#include "latency_histogram.h"
+#include "stat_writer.h"
 
 namespace OHOS {
 class LocalAbilityManagerDumper {
@@ -29,12 +33,18 @@ public:
     static bool StartIpcStatistics(std::string& result);
     static bool StopIpcStatistics(std::string& result);
     static bool GetIpcStatistics(std::string& result);
+    // Streams the ipc statistics into writer, as one CSV row per (callingPid, descriptor, code) if csv is set.
+    static bool WriteIpcStatistics(StatWriter& writer, bool csv);
     static bool CollectFfrtStatistics(int32_t cmd, std::string& result);
 private:
     static bool StartFfrtStatistics(std::string& result);
     static bool StopFfrtStatistics(std::string& result);
     static bool GetFfrtStatistics(std::string& result);
     static void FfrtStatisticsParser(std::string& result);
+    // Appends the TOP_TASK_NAME_NUM task names with the largest total time, one line each.
+    static void FfrtTopTasksParser(const std::unordered_map<std::string_view, LatencyHistogram>& taskStats,
+        std::string& result);
+    static void WriteIpcStatisticsCsv(StatWriter& writer);
     static void ClearFfrtStatisticsBufferLocked();
     static void ClearFfrtStatistics();
     static std::shared_ptr<FFRTHandler> handler_;
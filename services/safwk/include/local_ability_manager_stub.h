@@ -17,22 +17,121 @@
 #ifndef LOCAL_ABILITY_MANAGER_STUB_H
 #define LOCAL_ABILITY_MANAGER_STUB_H
 
-#include <map>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
+#include "expire_lru_cache.h"
 #include "ipc_object_stub.h"
 #include "refbase.h"
 #include "if_local_ability_manager.h"
 #include "nlohmann/json.hpp"
 
 namespace OHOS {
+namespace Security::AccessToken {
+class PermStateChangeCallbackCustomize;
+}
+class SystemAbilityExtensionReply;
+class SystemAbilityOnDemandReason;
+struct SaLifecycleCommand;
+
+// Codes served only by this safwk, kept far above SafwkInterfaceCode so new samgr codes never collide.
+// A caller sends QUERY_PROTOCOL_TRANSACTION once and keeps using the json codes if it fails.
+enum class SafwkBinaryInterfaceCode : uint32_t {
+    QUERY_PROTOCOL_TRANSACTION = 1000,
+    START_ABILITY_BINARY_TRANSACTION = 1001,
+    STOP_ABILITY_BINARY_TRANSACTION = 1002,
+    ACTIVE_ABILITY_BINARY_TRANSACTION = 1003,
+    IDLE_ABILITY_BINARY_TRANSACTION = 1004,
+    BATCH_LIFECYCLE_TRANSACTION = 1005,
+    SYSTEM_ABILITY_EXT_ASYNC_TRANSACTION = 1006,
+    LISTENER_STAT_CMD_TRANSACTION = 1007,
+    LIFECYCLE_METRICS_CMD_TRANSACTION = 1008,
+    SAFWK_TASK_STAT_CMD_TRANSACTION = 1009,
+};
+// Commands of LISTENER_STAT_CMD_TRANSACTION.
+enum ListenerStatCmd : int32_t {
+    LISTENER_STAT_CMD_GET = 0,
+    LISTENER_STAT_CMD_RESET = 1,
+    LISTENER_STAT_CMD_MAX = 2,
+};
+// Commands of LIFECYCLE_METRICS_CMD_TRANSACTION.
+enum LifecycleMetricsCmd : int32_t {
+    LIFECYCLE_METRICS_CMD_GET = 0,
+    LIFECYCLE_METRICS_CMD_RESET = 1,
+    LIFECYCLE_METRICS_CMD_MAX = 2,
+};
+// Commands of SAFWK_TASK_STAT_CMD_TRANSACTION.
+enum SafwkTaskStatCmd : int32_t {
+    SAFWK_TASK_STAT_CMD_GET = 0,
+    SAFWK_TASK_STAT_CMD_RESET = 1,
+    SAFWK_TASK_STAT_CMD_MAX = 2,
+};
+// Commands of IPC_STAT_CMD_TRANSACTION served only by this safwk, kept far above the samgr IPC_STAT_CMD_* values.
+enum IpcStatExtCmd : int32_t {
+    // Dumps the ipc statistics as CSV rows instead of the text form of IPC_STAT_CMD_GET.
+    IPC_STAT_CMD_GET_CSV = 1000,
+};
+// Lifecycle protocol version replied to QUERY_PROTOCOL_TRANSACTION, 1 carries reasons as
+// SystemAbilityOnDemandReason::Marshalling writes them, 2 adds BATCH_LIFECYCLE_TRANSACTION,
+// 3 accepts reasons that carry their extra data inline, 4 adds SYSTEM_ABILITY_EXT_ASYNC_TRANSACTION,
+// 5 adds LISTENER_STAT_CMD_TRANSACTION, 6 adds LIFECYCLE_METRICS_CMD_TRANSACTION,
+// 7 adds SAFWK_TASK_STAT_CMD_TRANSACTION.
+// Commands added to the dump transactions do not change it, an unknown command is rejected by its handler.
+constexpr int32_t LOCAL_ABILITY_PROTOCOL_VERSION = 7;
+// Max number of (saId, op, reason) entries in one BATCH_LIFECYCLE_TRANSACTION.
+constexpr int32_t MAX_LIFECYCLE_BATCH_NUM = 64;
+
+// Granted VerifyAccessToken verdicts keyed by token and permission. They are dropped when a permission change
+// is notified or once they are older than the expire time. The cache stays off, and Verify goes straight to
+// accesstoken, until Subscribe has set up that notification, which needs GET_SENSITIVE_PERMISSIONS.
+class PermissionVerdictCache {
+public:
+    PermissionVerdictCache();
+    static PermissionVerdictCache& GetInstance();
+    // Called once the process has started its SAs, off the request path.
+    bool Subscribe();
+    // permission must outlive the cache, its address is part of the key.
+    bool Verify(uint32_t tokenId, const std::string& permission);
+    void Invalidate();
+
+private:
+    ExpireLruCache<std::pair<uint32_t, uintptr_t>, bool> verdicts_;
+    std::atomic<uint64_t> generation_ {0};
+    std::atomic<bool> enabled_ {false};
+    std::shared_ptr<Security::AccessToken::PermStateChangeCallbackCustomize> callback_;
+};
+
 class LocalAbilityManagerStub : public IRemoteStub<ILocalAbilityManager> {
 public:
-    LocalAbilityManagerStub();
+    LocalAbilityManagerStub() = default;
     ~LocalAbilityManagerStub() = default;
     int32_t OnRemoteRequest(uint32_t code, MessageParcel& data, MessageParcel& reply, MessageOption& option) override;
+    // Reads eventId/name/value/extraDataId of an on-demand event in one pass, without building a json tree.
+    static bool ParseOnDemandReason(const std::string& eventStr, SystemAbilityOnDemandReason& reason);
 
 protected:
     static bool CheckInputSysAbilityId(int32_t systemAbilityId);
+    // Typed lifecycle entry points, the defaults fall back to the json interface.
+    virtual bool StartAbilityWithReason(int32_t systemAbilityId, SystemAbilityOnDemandReason&& startReason);
+    virtual bool StopAbilityWithReason(int32_t systemAbilityId, SystemAbilityOnDemandReason&& stopReason);
+    virtual bool ActiveAbilityWithReason(int32_t systemAbilityId, SystemAbilityOnDemandReason& activeReason);
+    virtual bool IdleAbilityWithReason(int32_t systemAbilityId, SystemAbilityOnDemandReason& idleReason,
+        int32_t& delayTime);
+    // Handles a whole batch, the default runs the entries one by one through the hooks above.
+    virtual void BatchLifecycle(std::vector<SaLifecycleCommand>& commands);
+    // Runs an extension whose reply goes back through a callback, SA_EXTENSION_PENDING leaves reply open.
+    virtual int32_t SystemAbilityExtProcAsync(const std::string& extension, int32_t said, MessageParcel& data,
+        const std::shared_ptr<SystemAbilityExtensionReply>& reply);
+    // Writes or resets the listener dispatch statistics, the default has none.
+    virtual bool ListenerStatCmdProc(int32_t fd, int32_t cmd);
+    // Writes or resets the lifecycle phase latency of the SAs in this process, the default has none.
+    virtual bool LifecycleMetricsCmdProc(int32_t fd, int32_t cmd);
+    // Writes or resets the statistics of the tasks safwk itself runs, the default has none.
+    virtual bool SafwkTaskStatCmdProc(int32_t fd, int32_t cmd);
 
 private:
     static int32_t LocalStartAbility(LocalAbilityManagerStub* stub, MessageParcel& data, MessageParcel& reply)
@@ -51,6 +150,30 @@ private:
     {
         return stub->IdleAbilityInner(data, reply);
     }
+    static int32_t LocalQueryProtocol(LocalAbilityManagerStub* stub, MessageParcel& data, MessageParcel& reply)
+    {
+        return stub->QueryProtocolInner(data, reply);
+    }
+    static int32_t LocalStartAbilityBinary(LocalAbilityManagerStub* stub, MessageParcel& data, MessageParcel& reply)
+    {
+        return stub->StartAbilityBinaryInner(data, reply);
+    }
+    static int32_t LocalStopAbilityBinary(LocalAbilityManagerStub* stub, MessageParcel& data, MessageParcel& reply)
+    {
+        return stub->StopAbilityBinaryInner(data, reply);
+    }
+    static int32_t LocalActiveAbilityBinary(LocalAbilityManagerStub* stub, MessageParcel& data, MessageParcel& reply)
+    {
+        return stub->ActiveAbilityBinaryInner(data, reply);
+    }
+    static int32_t LocalIdleAbilityBinary(LocalAbilityManagerStub* stub, MessageParcel& data, MessageParcel& reply)
+    {
+        return stub->IdleAbilityBinaryInner(data, reply);
+    }
+    static int32_t LocalBatchLifecycle(LocalAbilityManagerStub* stub, MessageParcel& data, MessageParcel& reply)
+    {
+        return stub->BatchLifecycleInner(data, reply);
+    }
     static int32_t LocalSendStrategyToSA(LocalAbilityManagerStub* stub, MessageParcel& data, MessageParcel& reply)
     {
         return stub->SendStrategyToSAInner(data, reply);
@@ -71,6 +194,26 @@ private:
     {
         return stub->SystemAbilityExtProcInner(data, reply);
     }
+    static int32_t LocalSystemAbilityExtAsync(LocalAbilityManagerStub* stub, MessageParcel& data,
+        MessageParcel& reply)
+    {
+        return stub->SystemAbilityExtAsyncInner(data, reply);
+    }
+    static int32_t LocalListenerStatCmdProc(LocalAbilityManagerStub* stub, MessageParcel& data,
+        MessageParcel& reply)
+    {
+        return stub->ListenerStatCmdProcInner(data, reply);
+    }
+    static int32_t LocalLifecycleMetricsCmdProc(LocalAbilityManagerStub* stub, MessageParcel& data,
+        MessageParcel& reply)
+    {
+        return stub->LifecycleMetricsCmdProcInner(data, reply);
+    }
+    static int32_t LocalSafwkTaskStatCmdProc(LocalAbilityManagerStub* stub, MessageParcel& data,
+        MessageParcel& reply)
+    {
+        return stub->SafwkTaskStatCmdProcInner(data, reply);
+    }
     static int32_t LocalServiceControlCmd(LocalAbilityManagerStub* stub, MessageParcel& data, MessageParcel& reply)
     {
         return stub->ServiceControlCmdInner(data, reply);
@@ -79,19 +222,38 @@ private:
     int32_t StopAbilityInner(MessageParcel& data, MessageParcel& reply);
     int32_t ActiveAbilityInner(MessageParcel& data, MessageParcel& reply);
     int32_t IdleAbilityInner(MessageParcel& data, MessageParcel& reply);
+    int32_t QueryProtocolInner(MessageParcel& data, MessageParcel& reply);
+    int32_t StartAbilityBinaryInner(MessageParcel& data, MessageParcel& reply);
+    int32_t StopAbilityBinaryInner(MessageParcel& data, MessageParcel& reply);
+    int32_t ActiveAbilityBinaryInner(MessageParcel& data, MessageParcel& reply);
+    int32_t IdleAbilityBinaryInner(MessageParcel& data, MessageParcel& reply);
+    int32_t BatchLifecycleInner(MessageParcel& data, MessageParcel& reply);
+    static int32_t ReadBinaryRequest(MessageParcel& data, int32_t& saId, SystemAbilityOnDemandReason& reason);
     int32_t SendStrategyToSAInner(MessageParcel& data, MessageParcel& reply);
     int32_t IpcStatCmdProcInner(MessageParcel& data, MessageParcel& reply);
     int32_t FfrtStatCmdProcInner(MessageParcel& data, MessageParcel& reply);
     int32_t FfrtDumperProcInner(MessageParcel& data, MessageParcel& reply);
     int32_t SystemAbilityExtProcInner(MessageParcel& data, MessageParcel& reply);
+    int32_t SystemAbilityExtAsyncInner(MessageParcel& data, MessageParcel& reply);
     int32_t ServiceControlCmdInner(MessageParcel& data, MessageParcel& reply);
+    int32_t ListenerStatCmdProcInner(MessageParcel& data, MessageParcel& reply);
+    int32_t LifecycleMetricsCmdProcInner(MessageParcel& data, MessageParcel& reply);
+    int32_t SafwkTaskStatCmdProcInner(MessageParcel& data, MessageParcel& reply);
+    // Reads the fd and command of a statistics request, the fd is closed if the command is missing.
+    static bool ReadStatCmd(MessageParcel& data, int32_t& fd, int32_t& cmd);
     static bool CanRequest();
     static bool EnforceInterceToken(MessageParcel& data);
     static bool CheckPermission(uint32_t code);
+    static bool VerifyPermission(const std::string& permission);
 
     using LocalAbilityManagerStubFunc =
         int32_t (*)(LocalAbilityManagerStub* stub, MessageParcel& data, MessageParcel& reply);
-    std::map<uint32_t, LocalAbilityManagerStubFunc> memberFuncMap_;
+    struct StubHandler {
+        LocalAbilityManagerStubFunc func = nullptr;
+        const std::string* permission = nullptr;
+    };
+    // Handler of code from tables built at compile time and indexed by code, nullptr if code is not served here.
+    static const StubHandler* GetStubHandler(uint32_t code);
 };
 }
 #endif
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef OHOS_SAFWK_SA_LIFECYCLE_COMMAND_H
+#define OHOS_SAFWK_SA_LIFECYCLE_COMMAND_H
+
+#include <cstdint>
+
+#include "system_ability_ondemand_reason.h"
+
+namespace OHOS {
+enum class SaLifecycleOp : int32_t {
+    START = 0,
+    STOP = 1,
+    ACTIVE = 2,
+    IDLE = 3,
+};
+
+// One entry of BATCH_LIFECYCLE_TRANSACTION, result and delayTime are filled in when it is handled.
+struct SaLifecycleCommand {
+    int32_t saId = -1;
+    SaLifecycleOp op = SaLifecycleOp::START;
+    SystemAbilityOnDemandReason reason;
+    bool result = false;
+    int32_t delayTime = 0;
+};
+}
+#endif // OHOS_SAFWK_SA_LIFECYCLE_COMMAND_H
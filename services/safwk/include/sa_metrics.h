@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SA_METRICS_H
+#define SA_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "datetime_ex.h"
+#include "latency_histogram.h"
+#include "single_instance.h"
+
+namespace OHOS {
+enum class SaPhase : uint32_t {
+    ON_START = 0,
+    ON_STOP,
+    ON_IDLE,
+    ON_ACTIVE,
+    PUBLISH,
+    REMOVE,
+    LOAD_LIB,
+    PHASE_NUM,
+};
+
+/**
+ * @class SaMetrics.
+ * Latency histograms of the lifecycle phases of each SA in this process. SAs get a slot on first record and
+ * keep it, the table has a fixed number of slots and both lookup and insertion are lock-free.
+ */
+class SaMetrics {
+    DECLARE_SINGLE_INSTANCE(SaMetrics);
+
+public:
+    static constexpr uint32_t MAX_SA_NUM = 128;
+
+    void Record(int32_t saId, SaPhase phase, uint64_t durationUs);
+    // Appends one line per recorded (SA, phase), sorted by SA id, durations in us.
+    void Dump(std::string& result);
+    void Reset();
+
+    // Records the time from its construction to its destruction.
+    class ScopedTimer {
+    public:
+        ScopedTimer(int32_t saId, SaPhase phase) : saId_(saId), phase_(phase), begin_(GetMicroTickCount()) {}
+        ~ScopedTimer();
+
+    private:
+        int32_t saId_;
+        SaPhase phase_;
+        int64_t begin_;
+    };
+
+private:
+    using PhaseHistograms = std::array<LatencyHistogram, static_cast<size_t>(SaPhase::PHASE_NUM)>;
+    PhaseHistograms* GetHistograms(int32_t saId);
+
+    // 0 marks a free slot, a slot is never released once an SA id is stored.
+    std::array<std::atomic<int32_t>, MAX_SA_NUM> saIds_ {};
+    std::array<std::atomic<PhaseHistograms*>, MAX_SA_NUM> histograms_ {};
+    std::atomic<bool> fullReported_ {false};
+};
+} // namespace OHOS
+#endif // SA_METRICS_H
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef OHOS_SAFWK_SERIAL_TASK_POOL_H
+#define OHOS_SAFWK_SERIAL_TASK_POOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace OHOS {
+/**
+ * @class SerialTaskPool.
+ * Runs serial task queues on at most threadNum dedicated threads, which are started on demand. Tasks of one queue
+ * run in order and never at the same time, different queues run in parallel. A task that blocks holds one of these
+ * threads and delays its own queue, but never an FFRT worker of the process. Each task is recorded in FfrtTaskStats.
+ */
+class SerialTaskPool {
+public:
+    SerialTaskPool(const std::string& name, uint32_t threadNum);
+    ~SerialTaskPool();
+    // Runs func on the queue once delayTime ms have passed. The task is recorded under statName, or under name if
+    // it is empty, so tasks removed by distinct names can still share one statistics entry.
+    bool PostTask(int32_t queueId, std::function<void()> func, const std::string& name, uint64_t delayTime,
+        const std::string& statName = "");
+    // Drops the pending tasks posted to the queue under name, a running one completes.
+    void RemoveTask(int32_t queueId, const std::string& name);
+    // Drops every pending task of the queue, a running one completes.
+    void RemoveQueue(int32_t queueId);
+
+private:
+    using Clock = std::chrono::steady_clock;
+    struct Task {
+        std::string name;
+        uint32_t statId;
+        std::function<void()> func;
+    };
+    struct DelayedTask {
+        int32_t queueId;
+        Task task;
+    };
+    void WorkLoop();
+    void ScheduleLocked(int32_t queueId, Task&& task);
+    void MoveDueTasksLocked(Clock::time_point now);
+    void WakeThreadLocked();
+
+    std::string name_;
+    uint32_t threadNum_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    // A queue is present while it waits in readyQueues_ or one of its tasks runs, guarded by mutex_.
+    std::map<int32_t, std::deque<Task>> queues_;
+    std::deque<int32_t> readyQueues_;
+    std::multimap<Clock::time_point, DelayedTask> delayedTasks_;
+    std::vector<std::thread> threads_;
+    // Waiting threads not yet claimed by a wake up, and wake ups not yet taken by a waking thread.
+    uint32_t idleThreadNum_ = 0;
+    uint32_t wakeNum_ = 0;
+    bool stopped_ = false;
+};
+} // namespace OHOS
+#endif // OHOS_SAFWK_SERIAL_TASK_POOL_H
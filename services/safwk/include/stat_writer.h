@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STAT_WRITER_H
+#define STAT_WRITER_H
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace OHOS {
+/**
+ * @class StatWriter.
+ * Formats a dump into a fixed buffer that is written out each time it fills up, so a large dump never
+ * lives in memory as a whole. The sink is either an fd, which stays owned by the caller, or a string.
+ * Once a write to the fd fails everything after it is dropped and Flush returns false.
+ */
+class StatWriter {
+public:
+    static constexpr size_t BUFFER_SIZE = 4096;
+
+    explicit StatWriter(int32_t fd) : fd_(fd) {}
+    explicit StatWriter(std::string& result) : result_(&result) {}
+    ~StatWriter();
+    StatWriter(const StatWriter&) = delete;
+    StatWriter& operator=(const StatWriter&) = delete;
+
+    StatWriter& Append(std::string_view str);
+    StatWriter& Append(char ch);
+    // Appends str as one CSV field, quoted when it holds a comma, a quote or a line break.
+    StatWriter& AppendCsvField(std::string_view str);
+
+    template<typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    StatWriter& AppendNumber(T value)
+    {
+        char num[MAX_NUMBER_LEN];
+        auto [end, ec] = std::to_chars(num, num + MAX_NUMBER_LEN, value);
+        return Append(std::string_view(num, end - num));
+    }
+
+    bool Flush();
+    bool IsFailed() const
+    {
+        return failed_;
+    }
+
+private:
+    static constexpr size_t MAX_NUMBER_LEN = 24;
+
+    void WriteOut(const char* data, size_t len);
+
+    int32_t fd_ = -1;
+    std::string* result_ = nullptr;
+    std::array<char, BUFFER_SIZE> buffer_ {};
+    size_t size_ = 0;
+    bool failed_ = false;
+};
+} // namespace OHOS
+#endif // STAT_WRITER_H
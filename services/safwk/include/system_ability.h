@@ -16,12 +16,14 @@
 #ifndef SYSTEM_ABILITY_H
 #define SYSTEM_ABILITY_H
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "iremote_object.h"
 #include "refbase.h"
+#include "system_ability_extension_reply.h"
 #include "system_ability_ondemand_reason.h"
 
 class CSystemAbilityInnerService;
@@ -79,6 +81,14 @@ public:
      */
     bool AddSystemAbilityListener(int32_t systemAbilityId);
 
+    /**
+     * AddSystemAbilityListeners, Listen to several SAs at once, SAs already present are notified as added.
+     *
+     * @param systemAbilityIds, saids that need to be monitored.
+     * @return Returns true if all of them are listened to.
+     */
+    bool AddSystemAbilityListeners(const std::vector<int32_t>& systemAbilityIds);
+
     /**
      * RemoveSystemAbilityListener, Remove the SA you are listening to.
      *
@@ -199,6 +209,13 @@ protected:
      */
     bool CancelIdle();
 
+    /**
+     * GetMergedStartReasons, Obtain all start reasons merged into the current start.
+     *
+     * @return start reasons in arrival order, the last one is the reason passed to OnStart.
+     */
+    std::vector<SystemAbilityOnDemandReason> GetMergedStartReasons();
+
     /**
      * StopAbility, Remove sa from samgr.
      *
@@ -238,6 +255,18 @@ protected:
      */
     virtual int32_t OnExtension(const std::string& extension, MessageParcel& data, MessageParcel& reply);
 
+    /**
+     * OnExtensionAsync, OnExtensionAsync will be called when extension is send asynchronously,
+     * by default it runs OnExtension into the reply.
+     *
+     * @param extension, the system ability extension name.
+     * @param data, extension data, only valid until OnExtensionAsync returns.
+     * @param reply, reply to complete, keep it and return SA_EXTENSION_PENDING to complete it later.
+     * @return int32_t, error code the reply is completed with, or SA_EXTENSION_PENDING.
+     */
+    virtual int32_t OnExtensionAsync(const std::string& extension, MessageParcel& data,
+        const std::shared_ptr<SystemAbilityExtensionReply>& reply);
+
 private:
     void Start();
     void Idle(SystemAbilityOnDemandReason& idleReason, int32_t& delayTime);
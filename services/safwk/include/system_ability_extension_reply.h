@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SYSTEM_ABILITY_EXTENSION_REPLY_H
+#define SYSTEM_ABILITY_EXTENSION_REPLY_H
+
+#include <atomic>
+#include <limits>
+#include <string>
+
+#include "iremote_object.h"
+#include "message_parcel.h"
+
+namespace OHOS {
+// Returned by OnExtensionAsync when the SA keeps the reply and completes it later.
+constexpr int32_t SA_EXTENSION_PENDING = std::numeric_limits<int32_t>::min();
+// Code of the oneway request that carries the result and the reply back to the caller's callback.
+constexpr uint32_t SA_EXTENSION_REPLY_CODE = 1;
+
+/**
+ * @class SystemAbilityExtensionReply.
+ * Reply of an asynchronous extension request, it may be completed from any thread.
+ */
+class SystemAbilityExtensionReply {
+public:
+    SystemAbilityExtensionReply(int32_t saId, const std::string& extension, const sptr<IRemoteObject>& callback);
+    /**
+     * Destroying a reply that was never completed completes it with ERR_INVALID_STATE, which sends the
+     * oneway SA_EXTENSION_REPLY_CODE request to the callback, so a caller is never left waiting.
+     * Call Complete before dropping the reply to send any other result.
+     */
+    ~SystemAbilityExtensionReply();
+
+    /**
+     * GetReply, parcel the SA writes its reply into before Complete.
+     *
+     * @return MessageParcel&, the reply parcel.
+     */
+    MessageParcel& GetReply();
+
+    /**
+     * Complete, send result followed by the reply to the caller, only the first call takes effect.
+     * A reply dropped without Complete is completed with ERR_INVALID_STATE.
+     *
+     * @param result, result of the extension.
+     * @return bool, true if the reply was sent.
+     */
+    bool Complete(int32_t result);
+
+    bool IsCompleted() const;
+
+private:
+    int32_t saId_;
+    std::string extension_;
+    sptr<IRemoteObject> callback_;
+    MessageParcel reply_;
+    std::atomic<bool> completed_ {false};
+};
+}
+#endif
@@ -17,6 +17,10 @@
 #define SERVICES_SAFWK_INCLUDE_SYSTEM_ABILITY_ONDEMAND_REASON_H
 
 #include <map>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
 #include "parcel.h"
 
 namespace OHOS {
@@ -30,19 +34,37 @@ enum class OnDemandReasonId {
     UNREF_EVENT = 6,
 };
 
+// Layout version written by SystemAbilityOnDemandReason::Marshalling, later versions only append fields.
+// 1 carries id, name, value and extraDataId, 2 appends the extra data itself in compact form when it is loaded.
+// From 2 on the version is followed by the byte size of the fields, so readers skip fields they do not know.
+constexpr int32_t ONDEMAND_REASON_PARCEL_VERSION = 2;
+
+// The members of OnDemandReasonExtraData and SystemAbilityOnDemandReason are not part of a stable ABI. The want
+// moved into shared WantState and the reason gained extraDataLoaded_, so both classes changed size. SAs that embed
+// or copy these classes must be rebuilt against this header together with libsystem_ability_fwk.
 class OnDemandReasonExtraData : public Parcelable {
 public:
+    using WantView = std::vector<std::pair<std::string_view, std::string_view>>;
     OnDemandReasonExtraData() = default;
     OnDemandReasonExtraData(int32_t code, const std::string& data, const std::map<std::string, std::string>& want);
     std::string GetData() const;
     int32_t GetCode() const;
     const std::map<std::string, std::string>& GetWant() const;
+    // Key/value pairs of the want in flat storage, decoded on first access and valid while this data lives.
+    const WantView& GetWantView() const;
     bool Marshalling(Parcel& parcel) const override;
     static OnDemandReasonExtraData *Unmarshalling(Parcel& parcel);
+    // Same fields without json, the want goes as one buffer of keys and values plus their lengths.
+    bool MarshallingCompact(Parcel& parcel) const;
+    static bool UnmarshallingCompact(Parcel& parcel, OnDemandReasonExtraData& extraData);
 private:
+    // code and data lead both the json and the compact form
+    bool MarshallingCodeAndData(Parcel& parcel) const;
+    static bool UnmarshallingCodeAndData(Parcel& parcel, int32_t& code, std::string& data);
+    struct WantState;
     int32_t code_ = -1;
     std::string data_;
-    std::map<std::string, std::string> want_;
+    std::shared_ptr<WantState> want_;
 };
 
 class SystemAbilityOnDemandReason {
@@ -61,12 +83,18 @@ public:
     bool HasExtraData() const;
     void SetExtraData(OnDemandReasonExtraData& extraData);
     const OnDemandReasonExtraData& GetExtraData() const;
+    bool IsExtraDataLoaded() const;
+    // Binary form of id, name, value and extraDataId, followed by the extra data once it is loaded.
+    bool Marshalling(Parcel& parcel) const;
+    static bool Unmarshalling(Parcel& parcel, SystemAbilityOnDemandReason& reason);
 private:
-    OnDemandReasonId reasonId_;
+    bool MarshallingFields(Parcel& parcel) const;
+    OnDemandReasonId reasonId_ = OnDemandReasonId::INTERFACE_CALL;
     std::string reasonName_;
     std::string reasonValue_;
     int64_t extraDataId_ = -1;
     OnDemandReasonExtraData extraData_;
+    bool extraDataLoaded_ = false;
 };
 }
 #endif /* SERVICES_SAFWK_INCLUDE_SYSTEM_ABILITY_ONDEMAND_REASON_H */
\ No newline at end of file
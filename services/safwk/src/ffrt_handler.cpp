@@ -18,6 +18,8 @@
 
 #include <limits>
 
+#include "datetime_ex.h"
+#include "ffrt_task_stats.h"
 #include "safwk_log.h"
 
 namespace OHOS {
@@ -38,12 +40,24 @@ bool FFRTHandler::PostTask(std::function<void()> func, const std::string& name,
         return false;
     }
     std::unique_lock<std::shared_mutex> lock(mutex_);
-    task_handle handler = queue_->submit_h(func, task_attr().delay(delayTime * CONVERSION_FACTOR));
+    // the stats id is looked up once per task name, the task itself only carries the id
+    auto item = taskMap_.find(name);
+    uint32_t nameId = (item != taskMap_.end()) ? item->second.nameId : FfrtTaskStats::GetInstance().GetNameId(name);
+    auto task = [func = std::move(func), nameId]() {
+        uint64_t startTime = static_cast<uint64_t>(GetMicroTickCount());
+        func();
+        FfrtTaskStats::GetInstance().Record(nameId, startTime, static_cast<uint64_t>(GetMicroTickCount()));
+    };
+    task_handle handler = queue_->submit_h(task, task_attr().delay(delayTime * CONVERSION_FACTOR));
     if (handler == nullptr) {
         LOGE("FFRTHandler post task failed");
         return false;
     }
-    taskMap_[name] = std::move(handler);
+    if (item != taskMap_.end()) {
+        item->second.handle = std::move(handler);
+    } else {
+        taskMap_.emplace(name, TaskEntry { std::move(handler), nameId });
+    }
     return true;
 }
 
@@ -55,8 +69,8 @@ void FFRTHandler::RemoveTask(const std::string& name)
         LOGW("rm task %{public}s NF", name.c_str());
         return;
     }
-    if (item->second != nullptr) {
-        auto ret = queue_->cancel(item->second);
+    if (item->second.handle != nullptr) {
+        auto ret = queue_->cancel(item->second.handle);
         if (ret != 0) {
             LOGE("cancel task failed, error code %{public}d", ret);
         }
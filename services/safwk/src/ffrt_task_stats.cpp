@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ffrt_task_stats.h"
+
+#include <algorithm>
+
+#include "safwk_log.h"
+
+namespace OHOS {
+IMPLEMENT_SINGLE_INSTANCE(FfrtTaskStats);
+
+uint32_t FfrtTaskStats::GetNameId(const std::string& taskName)
+{
+    std::lock_guard<std::mutex> autoLock(nameLock_);
+    auto iter = nameIds_.find(taskName);
+    if (iter != nameIds_.end()) {
+        return iter->second;
+    }
+    uint32_t nameId = nameNum_.load(std::memory_order_relaxed);
+    if (nameId >= MAX_TASK_NAME_NUM) {
+        if (!fullReported_) {
+            fullReported_ = true;
+            LOGW("ffrt task stats full, task %{public}s not aggregated", taskName.c_str());
+        }
+        return INVALID_NAME_ID;
+    }
+    names_[nameId] = taskName;
+    histograms_[nameId] = std::make_unique<LatencyHistogram>();
+    nameIds_.emplace(taskName, nameId);
+    nameNum_.store(nameId + 1, std::memory_order_release);
+    return nameId;
+}
+
+std::string FfrtTaskStats::GetName(uint32_t nameId) const
+{
+    return (nameId < nameNum_.load(std::memory_order_acquire)) ? names_[nameId] : "unknown";
+}
+
+void FfrtTaskStats::Record(uint32_t nameId, uint64_t startTime, uint64_t endTime)
+{
+    if (nameId < MAX_TASK_NAME_NUM) {
+        histograms_[nameId]->Record(endTime >= startTime ? endTime - startTime : 0);
+    }
+    uint64_t index = ringCount_.fetch_add(1, std::memory_order_relaxed);
+    RingSlot& slot = ring_[index % RING_SIZE];
+    // readers drop a slot whose seq is not the one they expect before and after reading it
+    slot.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.nameId.store(nameId, std::memory_order_relaxed);
+    slot.startTime.store(startTime, std::memory_order_relaxed);
+    slot.endTime.store(endTime, std::memory_order_relaxed);
+    slot.seq.store(index + 1, std::memory_order_release);
+}
+
+void FfrtTaskStats::Record(const std::string& taskName, uint64_t startTime, uint64_t endTime)
+{
+    Record(GetNameId(taskName), startTime, endTime);
+}
+
+void FfrtTaskStats::AppendTaskSummaries(std::vector<TaskSummary>& summaries, size_t maxNum, std::string& result)
+{
+    size_t num = std::min(summaries.size(), maxNum);
+    std::partial_sort(summaries.begin(), summaries.begin() + num, summaries.end(),
+        [](const auto& left, const auto& right) { return left.second.sum > right.second.sum; });
+    for (size_t i = 0; i < num; ++i) {
+        result.append(summaries[i].first);
+        result.append(" sum:" + std::to_string(summaries[i].second.sum) + " ");
+        LatencyHistogram::FormatSummary(summaries[i].second, result);
+        result.append("\n");
+    }
+}
+
+void FfrtTaskStats::Dump(std::string& result)
+{
+    std::vector<TaskSummary> summaries;
+    uint32_t nameNum = nameNum_.load(std::memory_order_acquire);
+    summaries.reserve(nameNum);
+    for (uint32_t nameId = 0; nameId < nameNum; ++nameId) {
+        LatencyHistogram::Summary summary = histograms_[nameId]->GetSummary();
+        if (summary.count > 0) {
+            summaries.emplace_back(names_[nameId], summary);
+        }
+    }
+    struct RecentTask {
+        uint32_t nameId;
+        uint64_t startTime;
+        uint64_t endTime;
+    };
+    std::vector<RecentTask> recent;
+    uint64_t count = ringCount_.load(std::memory_order_acquire);
+    uint64_t base = std::min(ringBase_.load(std::memory_order_relaxed), count);
+    uint64_t first = std::max(base, (count > RING_SIZE) ? count - RING_SIZE : 0);
+    recent.reserve(count - first);
+    for (uint64_t index = first; index < count; ++index) {
+        const RingSlot& slot = ring_[index % RING_SIZE];
+        if (slot.seq.load(std::memory_order_acquire) != index + 1) {
+            continue;
+        }
+        RecentTask task = { slot.nameId.load(std::memory_order_relaxed),
+            slot.startTime.load(std::memory_order_relaxed), slot.endTime.load(std::memory_order_relaxed) };
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) == index + 1) {
+            recent.push_back(task);
+        }
+    }
+    result.append("scope:tasks posted by safwk only, listener notifications, prewarm and the statistics clear timer, "
+        "not the ffrt tasks of the SAs\n");
+    result.append("tasks:" + std::to_string(count - base) + " taskNames:" + std::to_string(summaries.size()) + "\n");
+    AppendTaskSummaries(summaries, summaries.size(), result);
+    result.append("-------------------------------------------------------------------------------------------\n");
+    result.append("taskName                                                        startTime(us)   endTime(us)\n");
+    result.append("-------------------------------------------------------------------------------------------\n");
+    for (const auto& task : recent) {
+        result.append(GetName(task.nameId));
+        result.append(" " + std::to_string(task.startTime) + " " + std::to_string(task.endTime) + "\n");
+    }
+    result.append("-------------------------------------------------------------------------------------------\n");
+}
+
+void FfrtTaskStats::Reset()
+{
+    // Record may be writing to a histogram meanwhile, so they are cleared rather than released.
+    uint32_t nameNum = nameNum_.load(std::memory_order_acquire);
+    for (uint32_t nameId = 0; nameId < nameNum; ++nameId) {
+        histograms_[nameId]->Reset();
+    }
+    ringBase_.store(ringCount_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+} // namespace OHOS
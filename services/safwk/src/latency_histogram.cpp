@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "latency_histogram.h"
+
+#include <algorithm>
+
+namespace OHOS {
+namespace {
+constexpr uint64_t PERMILLE_P50 = 500;
+constexpr uint64_t PERMILLE_P90 = 900;
+constexpr uint64_t PERMILLE_P99 = 990;
+constexpr uint64_t PERMILLE_P999 = 999;
+constexpr uint64_t PERMILLE = 1000;
+
+// Rank of the sample at the permille, counted from 1.
+uint64_t GetRank(uint64_t count, uint64_t permille)
+{
+    return std::max<uint64_t>(1, (count * permille + PERMILLE - 1) / PERMILLE);
+}
+}
+
+uint32_t LatencyHistogram::GetBucketIndex(uint64_t durationUs)
+{
+    if (durationUs < SUB_BUCKET_NUM) {
+        return static_cast<uint32_t>(durationUs);
+    }
+    uint32_t exponent = 63 - static_cast<uint32_t>(__builtin_clzll(durationUs));
+    if (exponent >= MAX_EXPONENT) {
+        return BUCKET_NUM - 1;
+    }
+    uint32_t subIndex = static_cast<uint32_t>(durationUs >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKET_NUM - 1);
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKET_NUM + subIndex;
+}
+
+uint64_t LatencyHistogram::GetBucketUpperBound(uint32_t index)
+{
+    if (index < SUB_BUCKET_NUM) {
+        return index;
+    }
+    if (index >= BUCKET_NUM - 1) {
+        return UINT64_MAX;
+    }
+    uint32_t exponent = index / SUB_BUCKET_NUM + SUB_BUCKET_BITS - 1;
+    uint64_t subIndex = index % SUB_BUCKET_NUM;
+    uint32_t shift = exponent - SUB_BUCKET_BITS;
+    return ((SUB_BUCKET_NUM + subIndex + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t durationUs)
+{
+    buckets_[GetBucketIndex(durationUs)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(durationUs, std::memory_order_relaxed);
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (durationUs > max && !max_.compare_exchange_weak(max, durationUs, std::memory_order_relaxed)) {
+    }
+}
+
+LatencyHistogram::Summary LatencyHistogram::GetSummary() const
+{
+    Summary summary;
+    std::array<uint32_t, BUCKET_NUM> buckets;
+    uint64_t count = 0;
+    for (uint32_t i = 0; i < BUCKET_NUM; ++i) {
+        buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        count += buckets[i];
+    }
+    summary.count = count;
+    summary.sum = sum_.load(std::memory_order_relaxed);
+    summary.max = max_.load(std::memory_order_relaxed);
+    if (count == 0) {
+        return summary;
+    }
+    const std::pair<uint64_t, uint64_t*> ranks[] = {
+        { GetRank(count, PERMILLE_P50), &summary.p50 },
+        { GetRank(count, PERMILLE_P90), &summary.p90 },
+        { GetRank(count, PERMILLE_P99), &summary.p99 },
+        { GetRank(count, PERMILLE_P999), &summary.p999 },
+    };
+    size_t next = 0;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < BUCKET_NUM && next < std::size(ranks); ++i) {
+        seen += buckets[i];
+        while (next < std::size(ranks) && seen >= ranks[next].first) {
+            // a bucket bound above the largest sample is reported as that sample
+            *ranks[next].second = std::min(GetBucketUpperBound(i), summary.max);
+            ++next;
+        }
+    }
+    return summary;
+}
+
+void LatencyHistogram::Reset()
+{
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::FormatSummary(const Summary& summary, std::string& result)
+{
+    uint64_t avg = (summary.count == 0) ? 0 : summary.sum / summary.count;
+    result.append("count:" + std::to_string(summary.count));
+    result.append(" avg:" + std::to_string(avg));
+    result.append(" p50:" + std::to_string(summary.p50));
+    result.append(" p90:" + std::to_string(summary.p90));
+    result.append(" p99:" + std::to_string(summary.p99));
+    result.append(" p999:" + std::to_string(summary.p999));
+    result.append(" max:" + std::to_string(summary.max));
+}
+} // namespace OHOS
@@ -15,8 +15,11 @@
 
 #include "local_ability_manager.h"
 
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
 #include <cinttypes>
+#include <cstring>
 #include <dlfcn.h>
 #include <iostream>
 #include <sys/types.h>
@@ -32,15 +35,18 @@
 #include "string_ex.h"
 #include "hisysevent_adapter.h"
 #include "system_ability_ondemand_reason.h"
+#include "ffrt_handler.h"
+#include "ffrt_task_stats.h"
+#include "serial_task_pool.h"
 #include "local_ability_manager_dumper.h"
+#include "parameter.h"
 #include "timer.h"
 #include "hisysevent_adapter.h"
 #include "system_ability_definition.h"
+#include "sa_metrics.h"
 #include "samgr_xcollie.h"
-#ifdef SAFWK_ENABLE_RUN_ON_DEMAND_QOS
 #include <sys/syscall.h>
 #include <sys/resource.h>
-#endif
 
 namespace OHOS {
 using std::u16string;
@@ -48,32 +54,60 @@ using std::string;
 using std::vector;
 
 namespace {
-constexpr int32_t RETRY_TIMES_FOR_ONDEMAND = 10;
-constexpr int32_t RETRY_TIMES_FOR_SAMGR = 50;
 constexpr int32_t DEFAULT_SAID = -1;
 constexpr int32_t UNUSED_ONDEMAND_TIMER_INTERVAL_MSECONDS = 1000 * 60 * 1;
 constexpr int32_t ONDEMAND_SA_UNUSED_TIMEOUT_LOWLIMIT = UNUSED_ONDEMAND_TIMER_INTERVAL_MSECONDS;
 constexpr int32_t ONDEMAND_SA_UNUSED_TIMEOUT_UPLIMIT = 1000 * 60 * 120;
-constexpr std::chrono::milliseconds MILLISECONDS_WAITING_SAMGR_ONE_TIME(200);
-constexpr std::chrono::milliseconds MILLISECONDS_WAITING_ONDEMAND_ONE_TIME(100);
+constexpr std::chrono::milliseconds MILLISECONDS_WAITING_SAMGR_MIN(10);
+constexpr std::chrono::milliseconds MILLISECONDS_WAITING_SAMGR_MAX(200);
+constexpr std::chrono::milliseconds MILLISECONDS_WAITING_ONDEMAND_TIMEOUT(1000);
 constexpr int32_t TIME_S_TO_MS = 1000;
 constexpr int32_t MAX_STARTSA_TIMEOUT = 65;
 constexpr int32_t MAX_CHECK_TIMEOUT = 10;
 
 constexpr int32_t MAX_SA_STARTUP_TIME = 100;
+constexpr int64_t MAX_LISTENER_NOTIFY_TIME = 100;
+constexpr int64_t US_PER_MS = 1000;
+constexpr int64_t MAX_LISTENER_COALESCE_MSECONDS = 1000;
+// Batched listener adds checking at least this many SAs list samgr once instead of checking each.
+constexpr size_t MIN_LISTED_CHECK_NUM = 4;
 constexpr int32_t SUFFIX_LENGTH = 5; // .json length
 constexpr uint32_t FFRT_DUMP_INFO_ALL = 0;
 constexpr int FFRT_BUFFER_SIZE = 512 * 1024;
 
 #ifdef SAFWK_ENABLE_RUN_ON_DEMAND_QOS
 constexpr int OPEN_SO_PRIO = -20;
-constexpr int NORMAL_PRIO = 0;
 #endif
+constexpr int NORMAL_PRIO = 0;
+constexpr int USER_VISIBLE_PRIO = -10;
+constexpr int BACKGROUND_PRIO = 10;
+// Longest time a background start waits for in-flight user-visible starts.
+constexpr std::chrono::milliseconds MILLISECONDS_BACKGROUND_YIELD_TIMEOUT(1000);
 
 constexpr const char* PROFILES_DIR = "/system/profile/";
 constexpr const char* PREFIX = PROFILES_DIR;
 constexpr const char* SUFFIX = "_trust.json";
 
+constexpr const char* SA_TAG_SYSTEM_ABILITY = "systemability";
+constexpr const char* SA_TAG_NAME = "name";
+constexpr const char* SA_TAG_PREWARM = "prewarm";
+constexpr const char* SA_TAG_PRIORITY_CLASS = "priority-class";
+constexpr const char* SA_TAG_LISTENER_COALESCE = "listener-coalesce-ms";
+constexpr const char* PRIORITY_CLASS_USER_VISIBLE = "user-visible";
+constexpr const char* PRIORITY_CLASS_BACKGROUND = "background";
+constexpr const char* PREWARM_TASK = "SaPrewarm";
+constexpr const char* LISTENER_NOTIFY_TASK = "SaListenerNotify";
+constexpr const char* LISTENER_COALESCE_TASK = "SaListenerCoalesce";
+constexpr const char* LISTENER_POOL = "SaListener";
+// Listener callbacks often block on binder calls, so they run on a few threads of their own rather than on FFRT.
+constexpr uint32_t LISTENER_THREAD_NUM = 4;
+// Prewarm only after no on-demand start was requested for this long.
+constexpr int64_t PREWARM_IDLE_MSECONDS = 3000;
+constexpr size_t PREWARM_MAX_PER_ROUND = 2;
+
+constexpr const char* SAMGR_READY_PARAM = "bootevent.samgr.ready";
+constexpr const char* SAMGR_READY_VALUE = "true";
+
 constexpr const char* ONDEMAND_WORKER = "SaOndemand";
 constexpr const char* INIT_POOL = "SaInit";
 
@@ -91,7 +125,6 @@ enum {
 
 IMPLEMENT_SINGLE_INSTANCE(LocalAbilityManager);
 
-#ifdef SAFWK_ENABLE_RUN_ON_DEMAND_QOS
 static void SetThreadPrio(int priority)
 {
     int tid = syscall(SYS_gettid);
@@ -100,17 +133,94 @@ static void SetThreadPrio(int priority)
         LOGE("set tid:%{public}d priority:%{public}d failed.", tid, priority);
     }
 }
-#endif
+
+static int GetPriorityClassPrio(SaPriorityClass priorityClass)
+{
+    switch (priorityClass) {
+        case SaPriorityClass::USER_VISIBLE:
+            return USER_VISIBLE_PRIO;
+        case SaPriorityClass::BACKGROUND:
+            return BACKGROUND_PRIO;
+        default:
+            return NORMAL_PRIO;
+    }
+}
+
+class ScopedThreadPrio {
+public:
+    explicit ScopedThreadPrio(SaPriorityClass priorityClass)
+    {
+        int priority = GetPriorityClassPrio(priorityClass);
+        if (priority == NORMAL_PRIO) {
+            return;
+        }
+        // pooled threads may run at any nice value, it is restored rather than reset to NORMAL_PRIO
+        errno = 0;
+        int tid = syscall(SYS_gettid);
+        previousPrio_ = getpriority(PRIO_PROCESS, tid);
+        if (previousPrio_ == -1 && errno != 0) {
+            LOGE("get tid:%{public}d priority failed.", tid);
+            return;
+        }
+        if (previousPrio_ != priority) {
+            SetThreadPrio(priority);
+            changed_ = true;
+        }
+    }
+    ~ScopedThreadPrio()
+    {
+        if (changed_) {
+            SetThreadPrio(previousPrio_);
+        }
+    }
+private:
+    int previousPrio_ = NORMAL_PRIO;
+    bool changed_ = false;
+};
+
+template<typename Record>
+typename std::vector<Record>::iterator LowerBoundRecord(std::vector<Record>& records, int32_t saId)
+{
+    return std::lower_bound(records.begin(), records.end(), saId,
+        [] (const Record& record, int32_t id) { return record.saId < id; });
+}
+
+template<typename Record>
+Record* FindRecord(std::vector<Record>& records, int32_t saId)
+{
+    auto iter = LowerBoundRecord(records, saId);
+    return (iter != records.end() && iter->saId == saId) ? &(*iter) : nullptr;
+}
+
+template<typename Record>
+Record& GetOrAddRecord(std::vector<Record>& records, int32_t saId)
+{
+    auto iter = LowerBoundRecord(records, saId);
+    if (iter == records.end() || iter->saId != saId) {
+        iter = records.insert(iter, Record());
+        iter->saId = saId;
+    }
+    return *iter;
+}
 
 LocalAbilityManager::LocalAbilityManager()
 {
     profileParser_ = std::make_shared<ParseUtil>();
     initPool_ = std::make_unique<ThreadPool>(INIT_POOL);
+    listenerPool_ = std::make_unique<SerialTaskPool>(LISTENER_POOL, LISTENER_THREAD_NUM);
 }
 
 LocalAbilityManager::~LocalAbilityManager()
 {
+    // its threads run listener callbacks that use the members below
+    listenerPool_ = nullptr;
     StopTimedQuery();
+    std::unique_lock<std::shared_mutex> writeLock(localAbilityMapLock_);
+    delete abilityRegistry_.exchange(nullptr);
+    for (auto retired : retiredRegistries_) {
+        delete retired;
+    }
+    retiredRegistries_.clear();
 }
 
 void LocalAbilityManager::DoStartSAProcess(const std::string& profilePath, int32_t saId)
@@ -150,6 +260,7 @@ void LocalAbilityManager::DoStartSAProcess(const std::string& profilePath, int32
     }
 
     StartTimedQuery();
+    SchedulePrewarm();
     IPCSkeleton::JoinWorkThread();
     HILOGE(TAG, "JoinWorkThread stop, will exit");
 }
@@ -186,23 +297,47 @@ bool LocalAbilityManager::CheckAndGetProfilePath(const std::string& profilePath,
 
 bool LocalAbilityManager::CheckSystemAbilityManagerReady()
 {
-    int32_t timeout = RETRY_TIMES_FOR_SAMGR;
-    constexpr int32_t duration = std::chrono::microseconds(MILLISECONDS_WAITING_SAMGR_ONE_TIME).count();
+    int64_t begin = GetTickCount();
     sptr<ISystemAbilityManager> samgrProxy = SystemAbilityManagerClient::GetInstance().GetSystemAbilityManager();
-    while (samgrProxy == nullptr) {
+    if (samgrProxy == nullptr) {
         HILOGI(TAG, "%{public}s waiting for samgr...", Str16ToStr8(procName_).c_str());
-        if (timeout > 0) {
-            usleep(duration);
-            samgrProxy = SystemAbilityManagerClient::GetInstance().GetSystemAbilityManager();
-        } else {
-            HILOGE(TAG, "wait for samgr time out (10s)");
-            return false;
-        }
-        timeout--;
+        samgrProxy = WaitForSystemAbilityManager(begin + MAX_CHECK_TIMEOUT * TIME_S_TO_MS);
+    }
+    samgrReadyWaitTime_ = GetTickCount() - begin;
+    if (samgrProxy == nullptr) {
+        HILOGE(TAG, "wait for samgr time out (10s)");
+        return false;
+    }
+    if (samgrReadyWaitTime_ > 0) {
+        HILOGI(TAG, "%{public}s samgr ready, wait:%{public}" PRId64 "ms",
+            Str16ToStr8(procName_).c_str(), samgrReadyWaitTime_);
     }
     return true;
 }
 
+sptr<ISystemAbilityManager> LocalAbilityManager::WaitForSystemAbilityManager(int64_t deadline)
+{
+    // samgr sets the ready parameter once it is published, so block on it rather than a fixed period.
+    int64_t remaining = deadline - GetTickCount();
+    int32_t waitSeconds = static_cast<int32_t>((remaining + TIME_S_TO_MS - 1) / TIME_S_TO_MS);
+    if (waitSeconds > 0 && WaitParameter(SAMGR_READY_PARAM, SAMGR_READY_VALUE, waitSeconds) != 0) {
+        HILOGW(TAG, "wait samgr ready param failed, fall back to polling");
+    }
+    // The parameter survives a samgr restart, keep polling with backoff until the proxy is really there.
+    std::chrono::milliseconds delay = MILLISECONDS_WAITING_SAMGR_MIN;
+    sptr<ISystemAbilityManager> samgrProxy = SystemAbilityManagerClient::GetInstance().GetSystemAbilityManager();
+    while (samgrProxy == nullptr) {
+        remaining = deadline - GetTickCount();
+        if (remaining <= 0) {
+            return nullptr;
+        }
+        std::this_thread::sleep_for(std::min(delay, std::chrono::milliseconds(remaining)));
+        delay = std::min(delay * 2, MILLISECONDS_WAITING_SAMGR_MAX);
+        samgrProxy = SystemAbilityManagerClient::GetInstance().GetSystemAbilityManager();
+    }
+    return samgrProxy;
+}
+
 bool LocalAbilityManager::InitSystemAbilityProfiles(const std::string& profilePath, int32_t saId)
 {
     LOGD("InitProfiles parse sa profiles!");
@@ -222,6 +357,7 @@ bool LocalAbilityManager::InitSystemAbilityProfiles(const std::string& profilePa
     if (isExist) {
         CheckTrustSa(path, process, saInfos);
     }
+    InitSaExtraCfg(profilePath);
     return InitializeSaProfiles(saId);
 }
 
@@ -272,8 +408,8 @@ bool LocalAbilityManager::AddAbility(SystemAbility* ability)
         return false;
     }
     std::unique_lock<std::shared_mutex> writeLock(localAbilityMapLock_);
-    auto iter = localAbilityMap_.find(saId);
-    if (iter != localAbilityMap_.end()) {
+    auto& record = GetSaRecordLocked(saId);
+    if (record.ability != nullptr) {
         HILOGW(TAG, "try to add existed SA:%{public}d!", saId);
         return false;
     }
@@ -284,7 +420,10 @@ bool LocalAbilityManager::AddAbility(SystemAbility* ability)
     ability->SetDependTimeout(saProfile.dependTimeout);
     ability->SetDistributed(saProfile.distributed);
     ability->SetDumpLevel(saProfile.dumpLevel);
-    localAbilityMap_.emplace(saId, ability);
+    record.ability = ability;
+    PublishAbilityRegistryLocked();
+    writeLock.unlock();
+    abilityAddedCV_.notify_all();
     return true;
 }
 
@@ -295,14 +434,108 @@ bool LocalAbilityManager::RemoveAbility(int32_t systemAbilityId)
         return false;
     }
     std::unique_lock<std::shared_mutex> writeLock(localAbilityMapLock_);
-    (void)localAbilityMap_.erase(systemAbilityId);
+    auto record = FindSaRecordLocked(systemAbilityId);
+    if (record != nullptr) {
+        record->ability = nullptr;
+    }
+    PublishAbilityRegistryLocked();
+    writeLock.unlock();
+    ReleaseListener(systemAbilityId);
     return true;
 }
 
+LocalAbilityManager::SaRecord* LocalAbilityManager::FindSaRecordLocked(int32_t saId)
+{
+    return FindRecord(saRecords_, saId);
+}
+
+LocalAbilityManager::SaRecord& LocalAbilityManager::GetSaRecordLocked(int32_t saId)
+{
+    return GetOrAddRecord(saRecords_, saId);
+}
+
+LocalAbilityManager::ListenerRecord* LocalAbilityManager::FindListenerRecordLocked(int32_t saId)
+{
+    return FindRecord(listenerRecords_, saId);
+}
+
+LocalAbilityManager::ListenerRecord& LocalAbilityManager::GetListenerRecordLocked(int32_t saId)
+{
+    return GetOrAddRecord(listenerRecords_, saId);
+}
+
+void LocalAbilityManager::PublishAbilityRegistryLocked()
+{
+    auto registry = new (std::nothrow) AbilityRegistry();
+    if (registry == nullptr) {
+        HILOGE(TAG, "alloc ability registry failed");
+        return;
+    }
+    // saRecords_ is sorted, so is the snapshot
+    for (const auto& record : saRecords_) {
+        if (record.ability != nullptr) {
+            registry->abilities.emplace_back(record.saId, record.ability);
+        }
+    }
+    AbilityRegistry* oldRegistry = abilityRegistry_.exchange(registry);
+    if (oldRegistry != nullptr) {
+        retiredRegistries_.emplace_back(oldRegistry);
+    }
+    // a reader pins a snapshot before checking it is still current, so an unpinned retired one is unreachable
+    std::vector<AbilityRegistry*> pinned;
+    for (const auto& hazard : registryHazards_) {
+        AbilityRegistry* pinnedRegistry = hazard.registry.load();
+        if (pinnedRegistry != nullptr) {
+            pinned.emplace_back(pinnedRegistry);
+        }
+    }
+    auto isPinned = [&pinned] (AbilityRegistry* retired) {
+        if (std::find(pinned.begin(), pinned.end(), retired) != pinned.end()) {
+            return true;
+        }
+        delete retired;
+        return false;
+    };
+    retiredRegistries_.erase(std::remove_if(retiredRegistries_.begin(), retiredRegistries_.end(), isPinned),
+        retiredRegistries_.end());
+}
+
+LocalAbilityManager::RegistryHazard* LocalAbilityManager::ClaimRegistryHazard()
+{
+    // the slot goes back to the pool when its thread exits
+    struct HazardOwner {
+        RegistryHazard* hazard = nullptr;
+        ~HazardOwner()
+        {
+            if (hazard != nullptr) {
+                hazard->claimed.store(false, std::memory_order_release);
+            }
+        }
+    };
+    thread_local HazardOwner owner;
+    if (owner.hazard != nullptr) {
+        return owner.hazard;
+    }
+    for (auto& hazard : registryHazards_) {
+        bool claimed = false;
+        if (hazard.claimed.compare_exchange_strong(claimed, true, std::memory_order_acq_rel)) {
+            owner.hazard = &hazard;
+            return owner.hazard;
+        }
+    }
+    return nullptr;
+}
+
 bool LocalAbilityManager::AddSystemAbilityListener(int32_t systemAbilityId, int32_t listenerSaId)
 {
-    if (!CheckInputSysAbilityId(systemAbilityId) || !CheckInputSysAbilityId(listenerSaId)) {
-        HILOGW(TAG, "SA:%{public}d or listenerSA:%{public}d invalid!", systemAbilityId, listenerSaId);
+    return AddSystemAbilityListeners({systemAbilityId}, listenerSaId);
+}
+
+bool LocalAbilityManager::AddSystemAbilityListeners(const std::vector<int32_t>& systemAbilityIds,
+    int32_t listenerSaId)
+{
+    if (!CheckInputSysAbilityId(listenerSaId)) {
+        HILOGW(TAG, "listenerSA:%{public}d invalid!", listenerSaId);
         return false;
     }
     auto samgrProxy = SystemAbilityManagerClient::GetInstance().GetSystemAbilityManager();
@@ -310,46 +543,179 @@ bool LocalAbilityManager::AddSystemAbilityListener(int32_t systemAbilityId, int3
         HILOGE(TAG, "failed to get samgrProxy");
         return false;
     }
-    bool isNeedNotify = false;
-    size_t listenerListSize = 0;
+    bool result = true;
+    // targets already subscribed by another listener only need a check, the rest need a subscription
+    std::vector<std::pair<int32_t, bool>> checkList;
+    std::vector<int32_t> subscribeList;
+    std::set<int32_t> visited;
     {
-        HILOGD(TAG, "SA:%{public}d, listenerSA:%{public}d", systemAbilityId, listenerSaId);
         std::lock_guard<std::mutex> autoLock(listenerLock_);
-        auto& listenerList = localListenerMap_[systemAbilityId];
-        auto iter = std::find_if(listenerList.begin(), listenerList.end(),
-            [listenerSaId](const std::pair<int32_t, ListenerState>& listener) {
-            return listener.first == listenerSaId;
-        });
-        if (listenerList.size() > 0) {
-            sptr<IRemoteObject> object = samgrProxy->CheckSystemAbility(systemAbilityId);
-            if (object != nullptr) {
-                isNeedNotify = true;
+        for (int32_t systemAbilityId : systemAbilityIds) {
+            if (!CheckInputSysAbilityId(systemAbilityId)) {
+                HILOGW(TAG, "SA:%{public}d invalid!", systemAbilityId);
+                result = false;
+                continue;
             }
+            if (!visited.insert(systemAbilityId).second) {
+                continue;
+            }
+            auto& listeners = GetListenerRecordLocked(systemAbilityId).listeners;
+            // a new listener starts as INIT, it is claimed below once samgr confirms the SA is there
+            bool isExisted = !listeners.emplace(listenerSaId, ListenerState::INIT).second;
+            LOGI("AddSaListener SA:%{public}d,listenerSA:%{public}d,size:%{public}zu", systemAbilityId,
+                listenerSaId, listeners.size());
+            if (listeners.size() > 1) {
+                checkList.emplace_back(systemAbilityId, isExisted);
+            } else {
+                subscribeList.push_back(systemAbilityId);
+            }
+        }
+    }
+    // samgr reports SAs that are already present to a new subscriber by itself
+    for (int32_t systemAbilityId : subscribeList) {
+        bool isSubscribed = false;
+        if (!SyncListenerSubscription(samgrProxy, systemAbilityId, isSubscribed)) {
+            result = false;
+        } else if (!isSubscribed) {
+            // a removal of the last listener raced with this add and left the subscription in place
+            checkList.emplace_back(systemAbilityId, false);
         }
-        if (iter == listenerList.end()) {
-            listenerList.push_back({listenerSaId,
-                (isNeedNotify) ? ListenerState::NOTIFIED : ListenerState::INIT});
+    }
+    // samgr is asked outside listenerLock_, so listener changes of other SAs do not wait for the round trips
+    std::vector<std::pair<int32_t, bool>> presentList = CheckPresentAbilities(samgrProxy, checkList);
+    for (int32_t systemAbilityId : ClaimListenerNotify(presentList, listenerSaId)) {
+        PostNotifyAbilityListener(systemAbilityId, listenerSaId, "", ISystemAbilityStatusChange::ON_ADD_SYSTEM_ABILITY);
+    }
+    return result;
+}
+
+bool LocalAbilityManager::SyncListenerSubscription(const sptr<ISystemAbilityManager>& samgrProxy,
+    int32_t systemAbilityId, bool& isSubscribed)
+{
+    // the record may change again while samgr is asked, the last caller for the SA sees the final record
+    std::lock_guard<std::mutex> subscribeLock(subscribeLocks_[static_cast<uint32_t>(systemAbilityId) %
+        SUBSCRIBE_LOCK_NUM]);
+    bool isNeeded = false;
+    {
+        std::lock_guard<std::mutex> autoLock(listenerLock_);
+        isNeeded = (FindListenerRecordLocked(systemAbilityId) != nullptr);
+        if (isNeeded == (subscribedSaIds_.count(systemAbilityId) > 0)) {
+            return true;
         }
-        listenerListSize = listenerList.size();
-        LOGI("AddSaListener SA:%{public}d,listenerSA:%{public}d,size:%{public}zu", systemAbilityId, listenerSaId,
-            listenerList.size());
     }
-    if (listenerListSize > 1) {
-        if (isNeedNotify) {
-            NotifyAbilityListener(systemAbilityId, listenerSaId, "",
-                ISystemAbilityStatusChange::ON_ADD_SYSTEM_ABILITY);
+    if (isNeeded) {
+        int32_t ret = samgrProxy->SubscribeSystemAbility(systemAbilityId, GetSystemAbilityStatusChange());
+        if (ret) {
+            HILOGE(TAG, "failed to subscribe SA:%{public}d, process name:%{public}s", systemAbilityId,
+                Str16ToStr8(procName_).c_str());
+            return false;
         }
+        isSubscribed = true;
+        std::lock_guard<std::mutex> autoLock(listenerLock_);
+        subscribedSaIds_.insert(systemAbilityId);
         return true;
     }
-    int32_t ret = samgrProxy->SubscribeSystemAbility(systemAbilityId, GetSystemAbilityStatusChange());
+    int32_t ret = samgrProxy->UnSubscribeSystemAbility(systemAbilityId, GetSystemAbilityStatusChange());
     if (ret) {
-        HILOGE(TAG, "failed to subscribe SA:%{public}d, process name:%{public}s", systemAbilityId,
-            Str16ToStr8(procName_).c_str());
+        HILOGE(TAG, "failed to unsubscribe SA:%{public}d, process name:%{public}s",
+            systemAbilityId, Str16ToStr8(procName_).c_str());
         return false;
     }
+    std::lock_guard<std::mutex> autoLock(listenerLock_);
+    subscribedSaIds_.erase(systemAbilityId);
     return true;
 }
 
+std::vector<std::pair<int32_t, bool>> LocalAbilityManager::CheckPresentAbilities(
+    const sptr<ISystemAbilityManager>& samgrProxy, const std::vector<std::pair<int32_t, bool>>& checkList)
+{
+    std::vector<std::pair<int32_t, bool>> presentList;
+    if (checkList.size() >= MIN_LISTED_CHECK_NUM) {
+        // one listing of the registered SAs replaces a round trip per target, an empty one means checking each
+        std::vector<std::u16string> saList = samgrProxy->ListSystemAbilities();
+        if (!saList.empty()) {
+            std::set<int32_t> registeredSaIds;
+            for (const auto& name : saList) {
+                int32_t saId = 0;
+                if (StrToInt(Str16ToStr8(name), saId)) {
+                    registeredSaIds.insert(saId);
+                }
+            }
+            for (const auto& item : checkList) {
+                if (registeredSaIds.count(item.first) > 0) {
+                    presentList.push_back(item);
+                }
+            }
+            return presentList;
+        }
+    }
+    for (const auto& item : checkList) {
+        if (samgrProxy->CheckSystemAbility(item.first) != nullptr) {
+            presentList.push_back(item);
+        }
+    }
+    return presentList;
+}
+
+std::vector<int32_t> LocalAbilityManager::ClaimListenerNotify(
+    const std::vector<std::pair<int32_t, bool>>& presentList, int32_t listenerSaId)
+{
+    std::vector<int32_t> notifyList;
+    std::lock_guard<std::mutex> autoLock(listenerLock_);
+    for (const auto& [systemAbilityId, isExisted] : presentList) {
+        auto listenerRecord = FindListenerRecordLocked(systemAbilityId);
+        if (listenerRecord == nullptr) {
+            continue;
+        }
+        auto iter = listenerRecord->listeners.find(listenerSaId);
+        if (iter == listenerRecord->listeners.end()) {
+            continue;
+        }
+        // a repeated add is notified again, NOTIFIED on a new one means an add event reached it meanwhile
+        if (isExisted || iter->second == ListenerState::INIT) {
+            iter->second = ListenerState::NOTIFIED;
+            notifyList.push_back(systemAbilityId);
+        }
+    }
+    return notifyList;
+}
+
+void LocalAbilityManager::ClearCoalescedEvent(int32_t systemAbilityId, int32_t listenerSaId)
+{
+    std::lock_guard<std::mutex> autoLock(listenerHandlerLock_);
+    auto iter = coalescedEvents_.find({systemAbilityId, listenerSaId});
+    if (iter != coalescedEvents_.end()) {
+        ClearCoalescedEventLocked(iter);
+    }
+}
+
+void LocalAbilityManager::ReleaseListener(int32_t listenerSaId)
+{
+    std::lock_guard<std::mutex> autoLock(listenerHandlerLock_);
+    for (auto iter = coalescedEvents_.begin(); iter != coalescedEvents_.end();) {
+        auto current = iter++;
+        if (current->first.second == listenerSaId) {
+            ClearCoalescedEventLocked(current);
+        }
+    }
+    // its pending notifications would only find the SA gone
+    listenerPool_->RemoveQueue(listenerSaId);
+    listenerStats_.erase(listenerSaId);
+}
+
+void LocalAbilityManager::ClearCoalescedEventLocked(
+    std::map<std::pair<int32_t, int32_t>, CoalescedEvent>::iterator iter)
+{
+    auto [systemAbilityId, listenerSaId] = iter->first;
+    bool isPending = (iter->second.pendingCode != 0);
+    coalescedEvents_.erase(iter);
+    if (!isPending) {
+        return;
+    }
+    // tasks are posted under listenerHandlerLock_ as well, so the one cancelled here is never a newer one
+    listenerPool_->RemoveTask(listenerSaId, LISTENER_COALESCE_TASK + std::to_string(systemAbilityId));
+}
+
 bool LocalAbilityManager::RemoveSystemAbilityListener(int32_t systemAbilityId, int32_t listenerSaId)
 {
     if (!CheckInputSysAbilityId(systemAbilityId) || !CheckInputSysAbilityId(listenerSaId)) {
@@ -360,23 +726,18 @@ bool LocalAbilityManager::RemoveSystemAbilityListener(int32_t systemAbilityId, i
     {
         HILOGD(TAG, "SA:%{public}d, listenerSA:%{public}d", systemAbilityId, listenerSaId);
         std::lock_guard<std::mutex> autoLock(listenerLock_);
-        if (localListenerMap_.count(systemAbilityId) == 0) {
+        auto listenerRecord = FindListenerRecordLocked(systemAbilityId);
+        if (listenerRecord == nullptr) {
             return true;
         }
-        auto& listenerList = localListenerMap_[systemAbilityId];
-        auto iter = std::find_if(listenerList.begin(), listenerList.end(),
-            [listenerSaId](const std::pair<int32_t, ListenerState>& listener) {
-            return listener.first == listenerSaId;
-        });
-        if (iter != listenerList.end()) {
-            listenerList.erase(iter);
-        }
-        HILOGI(TAG, "SA:%{public}d, size:%{public}zu", systemAbilityId,
-            listenerList.size());
-        if (!listenerList.empty()) {
+        auto& listeners = listenerRecord->listeners;
+        listeners.erase(listenerSaId);
+        ClearCoalescedEvent(systemAbilityId, listenerSaId);
+        HILOGI(TAG, "SA:%{public}d, size:%{public}zu", systemAbilityId, listeners.size());
+        if (!listeners.empty()) {
             return true;
         }
-        localListenerMap_.erase(systemAbilityId);
+        listenerRecords_.erase(LowerBoundRecord(listenerRecords_, systemAbilityId));
     }
 
     auto samgrProxy = SystemAbilityManagerClient::GetInstance().GetSystemAbilityManager();
@@ -384,13 +745,8 @@ bool LocalAbilityManager::RemoveSystemAbilityListener(int32_t systemAbilityId, i
         HILOGE(TAG, "failed to get samgrProxy");
         return false;
     }
-    int32_t ret = samgrProxy->UnSubscribeSystemAbility(systemAbilityId, GetSystemAbilityStatusChange());
-    if (ret) {
-        HILOGE(TAG, "failed to unsubscribe SA:%{public}d, process name:%{public}s",
-            systemAbilityId, Str16ToStr8(procName_).c_str());
-        return false;
-    }
-    return true;
+    bool isSubscribed = false;
+    return SyncListenerSubscription(samgrProxy, systemAbilityId, isSubscribed);
 }
 
 void LocalAbilityManager::NotifyAbilityListener(int32_t systemAbilityId, int32_t listenerSaId,
@@ -419,6 +775,115 @@ void LocalAbilityManager::NotifyAbilityListener(int32_t systemAbilityId, int32_t
     }
 }
 
+std::shared_ptr<LocalAbilityManager::ListenerStat> LocalAbilityManager::GetListenerStat(int32_t listenerSaId)
+{
+    std::lock_guard<std::mutex> autoLock(listenerHandlerLock_);
+    auto& stat = listenerStats_[listenerSaId];
+    if (stat == nullptr) {
+        stat = std::make_shared<ListenerStat>();
+    }
+    return stat;
+}
+
+void LocalAbilityManager::TimedNotifyAbilityListener(int32_t systemAbilityId, int32_t listenerSaId,
+    const std::string& deviceId, int32_t code, int64_t dueTime)
+{
+    auto stat = GetListenerStat(listenerSaId);
+    int64_t begin = GetMicroTickCount();
+    stat->queueing.Record(static_cast<uint64_t>(std::max<int64_t>(begin - dueTime, 0)));
+    {
+        SamgrXCollie samgrXCollie("safwk--notifyListener_" + ToString(listenerSaId));
+        NotifyAbilityListener(systemAbilityId, listenerSaId, deviceId, code);
+    }
+    int64_t duration = GetMicroTickCount() - begin;
+    stat->dispatch.Record(static_cast<uint64_t>(duration));
+    if (duration > MAX_LISTENER_NOTIFY_TIME * US_PER_MS) {
+        stat->slowCount.fetch_add(1, std::memory_order_relaxed);
+        HILOGW(TAG, "listener SA:%{public}d slow on SA:%{public}d,code:%{public}d,spend:%{public}" PRId64 "ms",
+            listenerSaId, systemAbilityId, code, duration / US_PER_MS);
+    } else {
+        HILOGD(TAG, "listener SA:%{public}d on SA:%{public}d,code:%{public}d,spend:%{public}" PRId64 "us",
+            listenerSaId, systemAbilityId, code, duration);
+    }
+}
+
+void LocalAbilityManager::PostNotifyAbilityListener(int32_t systemAbilityId, int32_t listenerSaId,
+    const std::string& deviceId, int32_t code)
+{
+    uint32_t coalesceTime = GetListenerCoalesceTime(listenerSaId);
+    if (coalesceTime > 0) {
+        PostCoalescedEvent(systemAbilityId, listenerSaId, deviceId, code, coalesceTime);
+        return;
+    }
+    // one serial queue per listener SA keeps its events in order, a slow listener delays itself and holds one thread
+    int64_t dueTime = GetMicroTickCount();
+    auto task = [this, systemAbilityId, listenerSaId, deviceId, code, dueTime] {
+        TimedNotifyAbilityListener(systemAbilityId, listenerSaId, deviceId, code, dueTime);
+    };
+    if (!listenerPool_->PostTask(listenerSaId, task, LISTENER_NOTIFY_TASK, 0)) {
+        HILOGW(TAG, "post notify listener SA:%{public}d failed, notify inline", listenerSaId);
+        task();
+    }
+}
+
+void LocalAbilityManager::PostCoalescedEvent(int32_t systemAbilityId, int32_t listenerSaId,
+    const std::string& deviceId, int32_t code, uint32_t coalesceTime)
+{
+    std::function<void()> task;
+    {
+        std::lock_guard<std::mutex> autoLock(listenerHandlerLock_);
+        auto& event = coalescedEvents_[{systemAbilityId, listenerSaId}];
+        bool isPending = (event.pendingCode != 0);
+        event.pendingCode = code;
+        event.deviceId = deviceId;
+        if (isPending) {
+            HILOGD(TAG, "listener SA:%{public}d merge SA:%{public}d,code:%{public}d", listenerSaId,
+                systemAbilityId, code);
+            return;
+        }
+        uint64_t taskSeq = ++coalesceTaskSeq_;
+        event.taskSeq = taskSeq;
+        int64_t dueTime = GetMicroTickCount() + static_cast<int64_t>(coalesceTime) * US_PER_MS;
+        task = [this, systemAbilityId, listenerSaId, dueTime, taskSeq] {
+            DeliverCoalescedEvent(systemAbilityId, listenerSaId, dueTime, taskSeq);
+        };
+        // the per target name only serves RemoveTask, the statistics keep one name for every target
+        if (listenerPool_->PostTask(listenerSaId, task, LISTENER_COALESCE_TASK + std::to_string(systemAbilityId),
+            coalesceTime, LISTENER_COALESCE_TASK)) {
+            return;
+        }
+    }
+    HILOGW(TAG, "post coalesced listener SA:%{public}d failed, notify inline", listenerSaId);
+    task();
+}
+
+void LocalAbilityManager::DeliverCoalescedEvent(int32_t systemAbilityId, int32_t listenerSaId, int64_t dueTime,
+    uint64_t taskSeq)
+{
+    int32_t code = 0;
+    std::string deviceId;
+    {
+        std::lock_guard<std::mutex> autoLock(listenerHandlerLock_);
+        auto iter = coalescedEvents_.find({systemAbilityId, listenerSaId});
+        // a task that was not cancelled in time must not deliver an entry posted after its own was cleared
+        if (iter == coalescedEvents_.end() || iter->second.pendingCode == 0 || iter->second.taskSeq != taskSeq) {
+            return;
+        }
+        auto& event = iter->second;
+        code = event.pendingCode;
+        deviceId = std::move(event.deviceId);
+        event.pendingCode = 0;
+        // the burst ended where the listener already is, e.g. remove then add of an SA it saw added
+        if (code == event.deliveredCode) {
+            HILOGI(TAG, "listener SA:%{public}d skip SA:%{public}d,code:%{public}d unchanged", listenerSaId,
+                systemAbilityId, code);
+            return;
+        }
+        event.deliveredCode = code;
+    }
+    TimedNotifyAbilityListener(systemAbilityId, listenerSaId, deviceId, code, dueTime);
+}
+
 void LocalAbilityManager::FindAndNotifyAbilityListeners(int32_t systemAbilityId,
     const std::string& deviceId, int32_t code)
 {
@@ -427,13 +892,13 @@ void LocalAbilityManager::FindAndNotifyAbilityListeners(int32_t systemAbilityId,
     std::vector<int32_t> listenerSaIdVec;
     {
         std::lock_guard<std::mutex> autoLock(listenerLock_);
-        auto iter = localListenerMap_.find(systemAbilityId);
-        if (iter == localListenerMap_.end()) {
+        auto listenerRecord = FindListenerRecordLocked(systemAbilityId);
+        if (listenerRecord == nullptr) {
             HILOGW(TAG, "SA:%{public}d not found", systemAbilityId);
             return;
         }
         if (code == ISystemAbilityStatusChange::ON_ADD_SYSTEM_ABILITY) {
-            for (auto& listener : iter->second) {
+            for (auto& listener : listenerRecord->listeners) {
                 if (listener.second == ListenerState::INIT) {
                     listenerSaIdVec.push_back(listener.first);
                     listener.second = ListenerState::NOTIFIED;
@@ -442,7 +907,7 @@ void LocalAbilityManager::FindAndNotifyAbilityListeners(int32_t systemAbilityId,
                 }
             }
         } else if (code == ISystemAbilityStatusChange::ON_REMOVE_SYSTEM_ABILITY) {
-            for (auto& listener : iter->second) {
+            for (auto& listener : listenerRecord->listeners) {
                 listenerSaIdVec.push_back(listener.first);
                 if (listener.second == ListenerState::NOTIFIED) {
                     listener.second = ListenerState::INIT;
@@ -451,7 +916,7 @@ void LocalAbilityManager::FindAndNotifyAbilityListeners(int32_t systemAbilityId,
         }
     }
     for (auto listenerSaId : listenerSaIdVec) {
-        NotifyAbilityListener(systemAbilityId, listenerSaId, deviceId, code);
+        PostNotifyAbilityListener(systemAbilityId, listenerSaId, deviceId, code);
     }
     LOGI("FindNotifyListeners SA:%{public}d,size:%{public}zu,code:%{public}d,spend:%{public}" PRId64 "ms",
         systemAbilityId, listenerSaIdVec.size(), code, GetTickCount() - begin);
@@ -481,14 +946,37 @@ bool LocalAbilityManager::OnStopAbility(int32_t systemAbilityId)
 
 SystemAbility* LocalAbilityManager::GetAbility(int32_t systemAbilityId)
 {
-    std::shared_lock<std::shared_mutex> readLock(localAbilityMapLock_);
-    auto it = localAbilityMap_.find(systemAbilityId);
-    if (it == localAbilityMap_.end()) {
+    SystemAbility* ability = nullptr;
+    RegistryHazard* hazard = ClaimRegistryHazard();
+    if (hazard == nullptr) {
+        // more reader threads than hazard slots, read the records under the lock instead
+        std::shared_lock<std::shared_mutex> readLock(localAbilityMapLock_);
+        auto record = FindSaRecordLocked(systemAbilityId);
+        ability = (record != nullptr) ? record->ability : nullptr;
+    } else {
+        AbilityRegistry* registry = abilityRegistry_.load();
+        while (true) {
+            hazard->registry.store(registry);
+            AbilityRegistry* current = abilityRegistry_.load();
+            if (current == registry) {
+                break;
+            }
+            registry = current;
+        }
+        if (registry != nullptr) {
+            const auto& abilities = registry->abilities;
+            auto it = std::lower_bound(abilities.begin(), abilities.end(), systemAbilityId,
+                [] (const std::pair<int32_t, SystemAbility*>& item, int32_t saId) { return item.first < saId; });
+            if (it != abilities.end() && it->first == systemAbilityId) {
+                ability = it->second;
+            }
+        }
+        hazard->registry.store(nullptr, std::memory_order_release);
+    }
+    if (ability == nullptr) {
         HILOGW(TAG, "SA:%{public}d not register", systemAbilityId);
-        return nullptr;
     }
-
-    return it->second;
+    return ability;
 }
 
 bool LocalAbilityManager::GetRunningStatus(int32_t systemAbilityId)
@@ -501,33 +989,26 @@ bool LocalAbilityManager::GetRunningStatus(int32_t systemAbilityId)
     return ability->GetRunningStatus();
 }
 
+bool LocalAbilityManager::LoadSaLib(int32_t saId)
+{
+    SaMetrics::ScopedTimer timer(saId, SaPhase::LOAD_LIB);
+    return profileParser_->LoadSaLib(saId);
+}
+
 void LocalAbilityManager::StartOndemandSystemAbility(int32_t systemAbilityId)
 {
     pthread_setname_np(pthread_self(), ONDEMAND_WORKER);
+    ScopedThreadPrio threadPrio(GetPriorityClass(systemAbilityId));
     LOGD("StartOndemandSa LoadSaLib SA:%{public}d library", systemAbilityId);
     int64_t begin = GetTickCount();
-    bool isExist = profileParser_->LoadSaLib(systemAbilityId);
+    bool isExist = LoadSaLib(systemAbilityId);
     LOGI("StartOndemandSa LoadSaLib SA:%{public}d,spend:%{public}" PRId64 "ms",
         systemAbilityId, (GetTickCount() - begin));
     if (!isExist) {
         HILOGW(TAG, "SA:%{public}d not found", systemAbilityId);
         return;
     }
-    int32_t timeout = RETRY_TIMES_FOR_ONDEMAND;
-    constexpr int32_t duration = std::chrono::microseconds(MILLISECONDS_WAITING_ONDEMAND_ONE_TIME).count();
-    while (timeout > 0) {
-        {
-            std::shared_lock<std::shared_mutex> readLock(localAbilityMapLock_);
-            auto it = localAbilityMap_.find(systemAbilityId);
-            if (it != localAbilityMap_.end()) {
-                break;
-            }
-        }
-        HILOGI(TAG, "waiting for SA:%{public}d...", systemAbilityId);
-        usleep(duration);
-        timeout--;
-    }
-    if (timeout <= 0) {
+    if (!WaitForAbilityAdded(systemAbilityId)) {
         HILOGE(TAG, "waiting for SA:%{public}d time out (1s)", systemAbilityId);
         return;
     }
@@ -537,17 +1018,399 @@ void LocalAbilityManager::StartOndemandSystemAbility(int32_t systemAbilityId)
     }
 }
 
+bool LocalAbilityManager::WaitForAbilityAdded(int32_t systemAbilityId)
+{
+    std::shared_lock<std::shared_mutex> readLock(localAbilityMapLock_);
+    auto isAdded = [this, systemAbilityId] () {
+        auto record = FindSaRecordLocked(systemAbilityId);
+        return record != nullptr && record->ability != nullptr;
+    };
+    if (isAdded()) {
+        return true;
+    }
+    HILOGI(TAG, "waiting for SA:%{public}d...", systemAbilityId);
+    return abilityAddedCV_.wait_for(readLock, MILLISECONDS_WAITING_ONDEMAND_TIMEOUT, isAdded);
+}
+
 bool LocalAbilityManager::StartAbility(int32_t systemAbilityId, const std::string& eventStr)
+{
+    SystemAbilityOnDemandReason startReason;
+    if (!ParseOnDemandReason(eventStr, startReason)) {
+        HILOGW(TAG, "StartSa parse reason failed,SA:%{public}d", systemAbilityId);
+    }
+    return StartAbilityWithReason(systemAbilityId, std::move(startReason));
+}
+
+bool LocalAbilityManager::StartAbilityWithReason(int32_t systemAbilityId, SystemAbilityOnDemandReason&& startReason)
 {
     LOGI("StartSa recv start SA:%{public}d req", systemAbilityId);
-    nlohmann::json startReason = ParseUtil::StringToJsonObj(eventStr);
-    SetStartReason(systemAbilityId, startReason);
-    auto task = [this, systemAbilityId] {this->StartOndemandSystemAbility(systemAbilityId);};
-    std::thread thread(task);
-    thread.detach();
+    RecordStartRequest(systemAbilityId);
+    std::lock_guard<std::mutex> autoLock(ondemandTaskLock_);
+    auto& task = QueueStartLocked(systemAbilityId, std::move(startReason));
+    RunOndemandTaskLocked(systemAbilityId, task);
     return true;
 }
 
+LocalAbilityManager::OndemandTask& LocalAbilityManager::QueueStartLocked(int32_t systemAbilityId,
+    SystemAbilityOnDemandReason&& startReason)
+{
+    auto& task = ondemandTaskMap_[systemAbilityId];
+    if (!task.startPending && GetPriorityClass(systemAbilityId) == SaPriorityClass::USER_VISIBLE) {
+        UpdateUserVisibleTaskNum(true);
+    }
+    task.startPending = true;
+    task.startReasons.emplace_back(std::move(startReason));
+    if (task.startReasons.size() > 1) {
+        LOGI("StartSa merge SA:%{public}d req,num:%{public}zu", systemAbilityId, task.startReasons.size());
+    }
+    return task;
+}
+
+LocalAbilityManager::OndemandTask& LocalAbilityManager::QueueStopLocked(int32_t systemAbilityId,
+    SystemAbilityOnDemandReason&& stopReason)
+{
+    auto& task = ondemandTaskMap_[systemAbilityId];
+    if (task.startPending) {
+        LOGI("StopSa cancel pending start SA:%{public}d,num:%{public}zu", systemAbilityId, task.startReasons.size());
+        task.startPending = false;
+        task.startReasons.clear();
+        if (GetPriorityClass(systemAbilityId) == SaPriorityClass::USER_VISIBLE) {
+            UpdateUserVisibleTaskNum(false);
+        }
+    }
+    task.stopPending = true;
+    task.stopReason = std::move(stopReason);
+    return task;
+}
+
+void LocalAbilityManager::BatchLifecycle(std::vector<SaLifecycleCommand>& commands)
+{
+    // SAs started by this batch share one worker that loads their libraries, then each one starts on its own worker
+    std::vector<int32_t> batchStartSaIds;
+    for (auto& command : commands) {
+        if (command.op == SaLifecycleOp::ACTIVE) {
+            command.result = ActiveAbilityWithReason(command.saId, command.reason);
+            continue;
+        }
+        if (command.op == SaLifecycleOp::IDLE) {
+            command.result = IdleAbilityWithReason(command.saId, command.reason, command.delayTime);
+            continue;
+        }
+        if (command.op == SaLifecycleOp::START) {
+            RecordStartRequest(command.saId);
+        }
+        std::lock_guard<std::mutex> autoLock(ondemandTaskLock_);
+        auto& task = (command.op == SaLifecycleOp::START) ?
+            QueueStartLocked(command.saId, std::move(command.reason)) :
+            QueueStopLocked(command.saId, std::move(command.reason));
+        command.result = true;
+        if (command.op == SaLifecycleOp::STOP || task.running) {
+            RunOndemandTaskLocked(command.saId, task);
+            continue;
+        }
+        batchStartSaIds.emplace_back(command.saId);
+    }
+    if (batchStartSaIds.empty()) {
+        return;
+    }
+    LOGI("BatchSa start num:%{public}zu", batchStartSaIds.size());
+    // counted as an on-demand task, so prewarm stays off while the worker loads libraries
+    ondemandTaskNum_++;
+    auto worker = [this, batchStartSaIds] {this->ProcessBatchStart(batchStartSaIds);};
+    std::thread thread(worker);
+    thread.detach();
+}
+
+void LocalAbilityManager::ProcessBatchStart(const std::vector<int32_t>& saIds)
+{
+    pthread_setname_np(pthread_self(), ONDEMAND_WORKER);
+    // user-visible and default SAs are dispatched first, background SAs only once their starts are done
+    std::vector<int32_t> userVisibleSaIds;
+    std::vector<int32_t> defaultSaIds;
+    std::vector<int32_t> backgroundSaIds;
+    for (int32_t saId : saIds) {
+        SaPriorityClass priorityClass = GetPriorityClass(saId);
+        if (priorityClass == SaPriorityClass::USER_VISIBLE) {
+            userVisibleSaIds.emplace_back(saId);
+        } else if (priorityClass == SaPriorityClass::BACKGROUND) {
+            backgroundSaIds.emplace_back(saId);
+        } else {
+            defaultSaIds.emplace_back(saId);
+        }
+    }
+    userVisibleSaIds.insert(userVisibleSaIds.end(), defaultSaIds.begin(), defaultSaIds.end());
+    StartBatchGroup(userVisibleSaIds);
+    if (!backgroundSaIds.empty()) {
+        YieldToUserVisibleTask(backgroundSaIds.front());
+        StartBatchGroup(backgroundSaIds);
+    }
+    ondemandTaskNum_--;
+}
+
+void LocalAbilityManager::StartBatchGroup(const std::vector<int32_t>& saIds)
+{
+    if (saIds.empty()) {
+        return;
+    }
+    LoadBatchLibraries(saIds);
+    // each SA starts on its own worker, so a slow OnStart only delays itself
+    std::lock_guard<std::mutex> autoLock(ondemandTaskLock_);
+    for (int32_t saId : saIds) {
+        auto iter = ondemandTaskMap_.find(saId);
+        if (iter != ondemandTaskMap_.end() && iter->second.startPending) {
+            RunOndemandTaskLocked(saId, iter->second);
+        }
+    }
+}
+
+void LocalAbilityManager::LoadBatchLibraries(const std::vector<int32_t>& saIds)
+{
+    int64_t begin = GetTickCount();
+    std::set<std::string> loadedLibs;
+    for (int32_t saId : saIds) {
+        {
+            // a later stop in the same batch may have cancelled the start already
+            std::lock_guard<std::mutex> autoLock(ondemandTaskLock_);
+            auto iter = ondemandTaskMap_.find(saId);
+            if (iter == ondemandTaskMap_.end() || !iter->second.startPending) {
+                continue;
+            }
+        }
+        SaProfile saProfile;
+        if (GetAbility(saId) != nullptr || !profileParser_->GetProfile(saId, saProfile)) {
+            continue;
+        }
+        // SAs sharing one library are registered by a single load
+        if (!loadedLibs.insert(saProfile.libPath).second) {
+            continue;
+        }
+        ScopedThreadPrio threadPrio(GetPriorityClass(saId));
+        if (!LoadSaLib(saId)) {
+            LOGW("BatchSa LoadSaLib fail,SA:%{public}d", saId);
+        }
+    }
+    LOGI("BatchSa LoadSaLib num:%{public}zu,lib:%{public}zu,spend:%{public}" PRId64 "ms",
+        saIds.size(), loadedLibs.size(), (GetTickCount() - begin));
+}
+
+void LocalAbilityManager::RunOndemandTaskLocked(int32_t systemAbilityId, OndemandTask& task)
+{
+    // one worker per SA drains its pending ops, later requests are merged into the table
+    if (task.running) {
+        return;
+    }
+    task.running = true;
+    ondemandTaskNum_++;
+    auto worker = [this, systemAbilityId] {this->ProcessOndemandTask(systemAbilityId);};
+    std::thread thread(worker);
+    thread.detach();
+}
+
+void LocalAbilityManager::ProcessOndemandTask(int32_t systemAbilityId)
+{
+    while (true) {
+        bool isStart = false;
+        {
+            std::lock_guard<std::mutex> autoLock(ondemandTaskLock_);
+            auto iter = ondemandTaskMap_.find(systemAbilityId);
+            if (iter == ondemandTaskMap_.end()) {
+                ondemandTaskNum_--;
+                return;
+            }
+            auto& task = iter->second;
+            if (task.stopPending) {
+                task.stopPending = false;
+                SetStopReason(systemAbilityId, std::move(task.stopReason));
+            } else if (task.startPending) {
+                task.startPending = false;
+                isStart = true;
+                SetMergedStartReasons(systemAbilityId, std::move(task.startReasons));
+                task.startReasons.clear();
+            } else {
+                ondemandTaskMap_.erase(iter);
+                ondemandTaskNum_--;
+                return;
+            }
+        }
+        if (isStart) {
+            YieldToUserVisibleTask(systemAbilityId);
+            StartOndemandSystemAbility(systemAbilityId);
+            if (GetPriorityClass(systemAbilityId) == SaPriorityClass::USER_VISIBLE) {
+                UpdateUserVisibleTaskNum(false);
+            }
+        } else {
+            StopOndemandSystemAbility(systemAbilityId);
+        }
+    }
+}
+
+void LocalAbilityManager::RecordStartRequest(int32_t systemAbilityId)
+{
+    std::lock_guard<std::mutex> autoLock(prewarmLock_);
+    ++startRequestCount_[systemAbilityId];
+    lastOndemandRequestTime_ = GetTickCount();
+}
+
+void LocalAbilityManager::InitSaExtraCfg(const std::string& profilePath)
+{
+    std::string profileStr;
+    if (!LoadStringFromFile(profilePath, profileStr) || (profileStr.find(SA_TAG_PREWARM) == std::string::npos &&
+        profileStr.find(SA_TAG_PRIORITY_CLASS) == std::string::npos &&
+        profileStr.find(SA_TAG_LISTENER_COALESCE) == std::string::npos)) {
+        return;
+    }
+    nlohmann::json profileJson = nlohmann::json::parse(profileStr, nullptr, false);
+    if (profileJson.is_discarded() || !profileJson.contains(SA_TAG_SYSTEM_ABILITY) ||
+        !profileJson[SA_TAG_SYSTEM_ABILITY].is_array()) {
+        return;
+    }
+    std::lock_guard<std::mutex> autoLock(prewarmLock_);
+    std::unique_lock<std::shared_mutex> writeLock(saExtraCfgLock_);
+    for (const auto& saJson : profileJson[SA_TAG_SYSTEM_ABILITY]) {
+        if (!saJson.is_object() || !saJson.contains(SA_TAG_NAME) || !saJson[SA_TAG_NAME].is_number_integer()) {
+            continue;
+        }
+        int32_t saId = saJson[SA_TAG_NAME].get<int32_t>();
+        if (saJson.contains(SA_TAG_PREWARM) && saJson[SA_TAG_PREWARM].is_boolean() &&
+            saJson[SA_TAG_PREWARM].get<bool>()) {
+            prewarmCfgSet_.insert(saId);
+        }
+        if (saJson.contains(SA_TAG_PRIORITY_CLASS) && saJson[SA_TAG_PRIORITY_CLASS].is_string()) {
+            std::string priorityClass = saJson[SA_TAG_PRIORITY_CLASS].get<std::string>();
+            if (priorityClass == PRIORITY_CLASS_USER_VISIBLE) {
+                priorityCfgMap_[saId] = SaPriorityClass::USER_VISIBLE;
+            } else if (priorityClass == PRIORITY_CLASS_BACKGROUND) {
+                priorityCfgMap_[saId] = SaPriorityClass::BACKGROUND;
+            }
+        }
+        if (saJson.contains(SA_TAG_LISTENER_COALESCE) && saJson[SA_TAG_LISTENER_COALESCE].is_number_integer()) {
+            int64_t coalesceTime = saJson[SA_TAG_LISTENER_COALESCE].get<int64_t>();
+            if (coalesceTime > 0 && coalesceTime <= MAX_LISTENER_COALESCE_MSECONDS) {
+                coalesceCfgMap_[saId] = static_cast<uint32_t>(coalesceTime);
+            }
+        }
+    }
+    HILOGI(TAG, "prewarm SA num:%{public}zu,priority SA num:%{public}zu,coalesce SA num:%{public}zu",
+        prewarmCfgSet_.size(), priorityCfgMap_.size(), coalesceCfgMap_.size());
+}
+
+void LocalAbilityManager::SchedulePrewarm()
+{
+    std::lock_guard<std::mutex> autoLock(prewarmLock_);
+    if (prewarmCfgSet_.empty() || prewarmPending_) {
+        return;
+    }
+    if (prewarmHandler_ == nullptr) {
+        prewarmHandler_ = std::make_shared<FFRTHandler>(PREWARM_TASK);
+    }
+    auto task = [this] {this->PrewarmOndemandSystemAbilities();};
+    prewarmPending_ = prewarmHandler_->PostTask(task, PREWARM_TASK, PREWARM_IDLE_MSECONDS);
+}
+
+std::vector<int32_t> LocalAbilityManager::GetPrewarmCandidates()
+{
+    std::vector<std::pair<uint32_t, int32_t>> hotList;
+    {
+        std::lock_guard<std::mutex> autoLock(prewarmLock_);
+        for (auto iter = prewarmCfgSet_.begin(); iter != prewarmCfgSet_.end();) {
+            SaProfile saProfile;
+            if (GetAbility(*iter) != nullptr || !profileParser_->GetProfile(*iter, saProfile) ||
+                saProfile.runOnCreate) {
+                iter = prewarmCfgSet_.erase(iter);
+                continue;
+            }
+            auto countIter = startRequestCount_.find(*iter);
+            hotList.emplace_back((countIter == startRequestCount_.end()) ? 0 : countIter->second, *iter);
+            ++iter;
+        }
+    }
+    // most requested first
+    std::stable_sort(hotList.begin(), hotList.end(), [] (const auto& lhs, const auto& rhs) {
+        return lhs.first > rhs.first;
+    });
+    std::vector<int32_t> candidates;
+    for (const auto& item : hotList) {
+        candidates.emplace_back(item.second);
+    }
+    return candidates;
+}
+
+void LocalAbilityManager::PrewarmOndemandSystemAbilities()
+{
+    int64_t lastRequestTime = 0;
+    {
+        std::lock_guard<std::mutex> autoLock(prewarmLock_);
+        prewarmPending_ = false;
+        lastRequestTime = lastOndemandRequestTime_;
+    }
+    if (ondemandTaskNum_ > 0 || (GetTickCount() - lastRequestTime) < PREWARM_IDLE_MSECONDS) {
+        SchedulePrewarm();
+        return;
+    }
+    std::vector<int32_t> candidates = GetPrewarmCandidates();
+    size_t loadNum = 0;
+    for (int32_t saId : candidates) {
+        if (loadNum >= PREWARM_MAX_PER_ROUND || ondemandTaskNum_ > 0) {
+            SchedulePrewarm();
+            return;
+        }
+        int64_t begin = GetTickCount();
+        bool ret = LoadSaLib(saId);
+        LOGI("PrewarmSa LoadSaLib SA:%{public}d,ret:%{public}d,spend:%{public}" PRId64 "ms",
+            saId, ret, (GetTickCount() - begin));
+        {
+            std::lock_guard<std::mutex> autoLock(prewarmLock_);
+            prewarmCfgSet_.erase(saId);
+        }
+        loadNum++;
+    }
+}
+
+SaPriorityClass LocalAbilityManager::GetPriorityClass(int32_t systemAbilityId)
+{
+    std::shared_lock<std::shared_mutex> readLock(saExtraCfgLock_);
+    auto iter = priorityCfgMap_.find(systemAbilityId);
+    return (iter == priorityCfgMap_.end()) ? SaPriorityClass::DEFAULT : iter->second;
+}
+
+uint32_t LocalAbilityManager::GetListenerCoalesceTime(int32_t listenerSaId)
+{
+    // coalesceCfgMap_ is filled before Run and read-only afterwards
+    auto iter = coalesceCfgMap_.find(listenerSaId);
+    return (iter == coalesceCfgMap_.end()) ? 0 : iter->second;
+}
+
+void LocalAbilityManager::UpdateUserVisibleTaskNum(bool isAdd)
+{
+    std::lock_guard<std::mutex> autoLock(priorityLock_);
+    if (isAdd) {
+        ++userVisibleTaskNum_;
+        return;
+    }
+    if (userVisibleTaskNum_ > 0) {
+        --userVisibleTaskNum_;
+    }
+    if (userVisibleTaskNum_ == 0) {
+        userVisibleCV_.notify_all();
+    }
+}
+
+void LocalAbilityManager::YieldToUserVisibleTask(int32_t systemAbilityId)
+{
+    if (GetPriorityClass(systemAbilityId) != SaPriorityClass::BACKGROUND) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(priorityLock_);
+    if (userVisibleTaskNum_ == 0) {
+        return;
+    }
+    LOGI("SA:%{public}d yield to user-visible start,num:%{public}d", systemAbilityId, userVisibleTaskNum_);
+    if (!userVisibleCV_.wait_for(lock, MILLISECONDS_BACKGROUND_YIELD_TIMEOUT,
+        [this] () { return userVisibleTaskNum_ == 0; })) {
+        HILOGW(TAG, "SA:%{public}d yield time out", systemAbilityId);
+    }
+}
+
 void LocalAbilityManager::StopOndemandSystemAbility(int32_t systemAbilityId)
 {
     pthread_setname_np(pthread_self(), ONDEMAND_WORKER);
@@ -557,56 +1420,82 @@ void LocalAbilityManager::StopOndemandSystemAbility(int32_t systemAbilityId)
 }
 
 bool LocalAbilityManager::StopAbility(int32_t systemAbilityId, const std::string& eventStr)
+{
+    SystemAbilityOnDemandReason stopReason;
+    if (!ParseOnDemandReason(eventStr, stopReason)) {
+        HILOGW(TAG, "StopSa parse reason failed,SA:%{public}d", systemAbilityId);
+    }
+    return StopAbilityWithReason(systemAbilityId, std::move(stopReason));
+}
+
+bool LocalAbilityManager::StopAbilityWithReason(int32_t systemAbilityId, SystemAbilityOnDemandReason&& stopReason)
 {
     LOGI("StopSa recv stop SA:%{public}d req", systemAbilityId);
-    nlohmann::json stopReason = ParseUtil::StringToJsonObj(eventStr);
-    SetStopReason(systemAbilityId, stopReason);
-    auto task = [this, systemAbilityId] {this->StopOndemandSystemAbility(systemAbilityId);};
-    std::thread thread(task);
-    thread.detach();
+    std::lock_guard<std::mutex> autoLock(ondemandTaskLock_);
+    auto& task = QueueStopLocked(systemAbilityId, std::move(stopReason));
+    RunOndemandTaskLocked(systemAbilityId, task);
     return true;
 }
 
 bool LocalAbilityManager::ActiveAbility(int32_t systemAbilityId,
     const nlohmann::json& activeReason)
+{
+    SystemAbilityOnDemandReason onDemandActiveReason = JsonToOnDemandReason(activeReason);
+    return ActiveAbilityWithReason(systemAbilityId, onDemandActiveReason);
+}
+
+bool LocalAbilityManager::ActiveAbilityWithReason(int32_t systemAbilityId,
+    SystemAbilityOnDemandReason& activeReason)
 {
     LOGD("ActiveSa:%{public}d", systemAbilityId);
     auto ability = GetAbility(systemAbilityId);
     if (ability == nullptr) {
         return false;
     }
-    SystemAbilityOnDemandReason onDemandActiveReason = JsonToOnDemandReason(activeReason);
-    ability->Active(onDemandActiveReason);
+    ability->Active(activeReason);
     return true;
 }
 
 bool LocalAbilityManager::IdleAbility(int32_t systemAbilityId,
     const nlohmann::json& idleReason, int32_t& delayTime)
+{
+    SystemAbilityOnDemandReason onDemandIdleReason = JsonToOnDemandReason(idleReason);
+    return IdleAbilityWithReason(systemAbilityId, onDemandIdleReason, delayTime);
+}
+
+bool LocalAbilityManager::IdleAbilityWithReason(int32_t systemAbilityId,
+    SystemAbilityOnDemandReason& idleReason, int32_t& delayTime)
 {
     HILOGD(TAG, "idle SA:%{public}d", systemAbilityId);
     auto ability = GetAbility(systemAbilityId);
     if (ability == nullptr) {
         return false;
     }
-    SystemAbilityOnDemandReason onDemandIdleReason = JsonToOnDemandReason(idleReason);
-    ability->Idle(onDemandIdleReason, delayTime);
+    ability->Idle(idleReason, delayTime);
     return true;
 }
 
 SystemAbilityOnDemandReason LocalAbilityManager::JsonToOnDemandReason(const nlohmann::json& reasonJson)
 {
     SystemAbilityOnDemandReason onDemandStartReason;
-    if (reasonJson.contains(EVENT_ID) && reasonJson[EVENT_ID].is_number()) {
-        onDemandStartReason.SetId(reasonJson[EVENT_ID]);
+    if (!reasonJson.is_object()) {
+        return onDemandStartReason;
     }
-    if (reasonJson.contains(NAME) && reasonJson[NAME].is_string()) {
-        onDemandStartReason.SetName(reasonJson[NAME]);
+    auto iter = reasonJson.find(EVENT_ID);
+    if (iter != reasonJson.end() && iter->is_number()) {
+        onDemandStartReason.SetId(iter->get<OnDemandReasonId>());
     }
-    if (reasonJson.contains(VALUE) && reasonJson[VALUE].is_string()) {
-        onDemandStartReason.SetValue(reasonJson[VALUE]);
+    iter = reasonJson.find(NAME);
+    if (iter != reasonJson.end() && iter->is_string()) {
+        onDemandStartReason.SetName(iter->get_ref<const std::string&>());
     }
-    if (reasonJson.contains(EXTRA_DATA_ID) && reasonJson[EXTRA_DATA_ID].is_number()) {
-        onDemandStartReason.SetExtraDataId(reasonJson[EXTRA_DATA_ID]);
+    iter = reasonJson.find(VALUE);
+    if (iter != reasonJson.end() && iter->is_string()) {
+        onDemandStartReason.SetValue(iter->get_ref<const std::string&>());
+    }
+    iter = reasonJson.find(EXTRA_DATA_ID);
+    if (iter != reasonJson.end() && iter->is_number()) {
+        onDemandStartReason.SetExtraDataId(iter->get<int64_t>());
     }
     return onDemandStartReason;
 }
@@ -618,7 +1507,7 @@ bool LocalAbilityManager::InitializeOnDemandSaProfile(int32_t saId)
 #ifdef SAFWK_ENABLE_RUN_ON_DEMAND_QOS
     SetThreadPrio(OPEN_SO_PRIO);
 #endif
-    bool result = profileParser_->LoadSaLib(saId);
+    bool result = LoadSaLib(saId);
 #ifdef SAFWK_ENABLE_RUN_ON_DEMAND_QOS
     SetThreadPrio(NORMAL_PRIO);
 #endif
@@ -639,13 +1528,12 @@ bool LocalAbilityManager::InitializeOnDemandSaProfile(int32_t saId)
 bool LocalAbilityManager::InitializeSaProfilesInnerLocked(const SaProfile& saProfile)
 {
     std::unique_lock<std::shared_mutex> readLock(localAbilityMapLock_);
-    auto iterProfile = localAbilityMap_.find(saProfile.saId);
-    if (iterProfile == localAbilityMap_.end()) {
+    auto record = FindSaRecordLocked(saProfile.saId);
+    if (record == nullptr) {
         HILOGW(TAG, "SA:%{public}d not found", saProfile.saId);
         return false;
     }
-    auto systemAbility = iterProfile->second;
-    if (systemAbility == nullptr) {
+    if (record->ability == nullptr) {
         HILOGW(TAG, "SA:%{public}d is null", saProfile.saId);
         return false;
     }
@@ -653,8 +1541,8 @@ bool LocalAbilityManager::InitializeSaProfilesInnerLocked(const SaProfile& saPro
         HILOGW(TAG, "invalid boot phase: %{public}d", saProfile.bootPhase);
         return false;
     }
-    auto& saList = abilityPhaseMap_[saProfile.bootPhase];
-    saList.emplace_back(systemAbility);
+    record->bootPhase = saProfile.bootPhase;
+    record->phaseSeq = ++phaseSeq_;
     return true;
 }
 
@@ -723,6 +1611,8 @@ void LocalAbilityManager::StartSystemAbilityTask(SystemAbility* ability)
     if (ability != nullptr) {
         SamgrXCollie samgrXCollie("StartSaTimeout_" + ToString(ability->GetSystemAbilitId()), MAX_STARTSA_TIMEOUT);
         HILOGD(TAG, "StartSystemAbility is called for SA:%{public}d", ability->GetSystemAbilitId());
+        // boot starts are ordered by priority class instead of yielding, a wait here would count against the watchdog
+        ScopedThreadPrio threadPrio(GetPriorityClass(ability->GetSystemAbilitId()));
         if (ability->GetDependSa().empty()) {
             ability->Start();
         } else {
@@ -773,7 +1663,15 @@ void LocalAbilityManager::StartPhaseTasks(const std::list<SystemAbility*>& syste
         return;
     }
 
-    for (auto systemAbility : systemAbilityList) {
+    // initPool_ is FIFO, queue user-visible SAs first and background SAs last
+    std::vector<SystemAbility*> sortedList(systemAbilityList.begin(), systemAbilityList.end());
+    std::stable_sort(sortedList.begin(), sortedList.end(), [this] (SystemAbility* lhs, SystemAbility* rhs) {
+        if (lhs == nullptr || rhs == nullptr) {
+            return false;
+        }
+        return GetPriorityClass(lhs->GetSystemAbilitId()) < GetPriorityClass(rhs->GetSystemAbilitId());
+    });
+    for (auto systemAbility : sortedList) {
         if (systemAbility != nullptr) {
             HILOGD(TAG, "add phase task for SA:%{public}d", systemAbility->GetSystemAbilitId());
             std::lock_guard<std::mutex> autoLock(startPhaseLock_);
@@ -799,13 +1697,34 @@ void LocalAbilityManager::WaitForTasks()
         Str16ToStr8(procName_).c_str(), (end - begin));
 }
 
+std::list<SystemAbility*> LocalAbilityManager::GetPhaseAbilities(uint32_t bootPhase)
+{
+    std::vector<std::pair<uint32_t, SystemAbility*>> phaseAbilities;
+    {
+        std::shared_lock<std::shared_mutex> readLock(localAbilityMapLock_);
+        for (const auto& record : saRecords_) {
+            if (record.ability != nullptr && record.bootPhase == bootPhase) {
+                phaseAbilities.emplace_back(record.phaseSeq, record.ability);
+            }
+        }
+    }
+    // keep the order in which the profiles were initialized
+    std::sort(phaseAbilities.begin(), phaseAbilities.end(),
+        [] (const auto& left, const auto& right) { return left.first < right.first; });
+    std::list<SystemAbility*> systemAbilityList;
+    for (const auto& phaseAbility : phaseAbilities) {
+        systemAbilityList.emplace_back(phaseAbility.second);
+    }
+    return systemAbilityList;
+}
+
 void LocalAbilityManager::FindAndStartPhaseTasks(int32_t saId)
 {
     if (saId == DEFAULT_SAID) {
         for (uint32_t bootPhase = BOOT_START; bootPhase <= OTHER_START; ++bootPhase) {
-            auto iter = abilityPhaseMap_.find(bootPhase);
-            if (iter != abilityPhaseMap_.end()) {
-                StartPhaseTasks(iter->second);
+            auto systemAbilityList = GetPhaseAbilities(bootPhase);
+            if (!systemAbilityList.empty()) {
+                StartPhaseTasks(systemAbilityList);
                 InitializeRunOnCreateSaProfiles(bootPhase + 1);
                 WaitForTasks();
             } else {
@@ -814,9 +1733,9 @@ void LocalAbilityManager::FindAndStartPhaseTasks(int32_t saId)
         }
     } else {
         for (uint32_t bootPhase = BOOT_START; bootPhase <= OTHER_START; ++bootPhase) {
-            auto iter = abilityPhaseMap_.find(bootPhase);
-            if (iter != abilityPhaseMap_.end()) {
-                StartPhaseTasks(iter->second);
+            auto systemAbilityList = GetPhaseAbilities(bootPhase);
+            if (!systemAbilityList.empty()) {
+                StartPhaseTasks(systemAbilityList);
                 WaitForTasks();
             }
         }
@@ -868,6 +1787,8 @@ bool LocalAbilityManager::Run(int32_t saId)
     RegisterOnDemandSystemAbility(saId);
     FindAndStartPhaseTasks(saId);
     initPool_->Stop();
+    // requests verify without the cache until this returns, so the boot starts are not held up by it
+    PermissionVerdictCache::GetInstance().Subscribe();
     return true;
 }
 
@@ -886,28 +1807,69 @@ bool LocalAbilityManager::AddLocalAbilityManager()
     return ret == ERR_OK;
 }
 
+void LocalAbilityManager::SetStartReason(int32_t saId, SystemAbilityOnDemandReason&& event)
+{
+    std::unique_lock<std::shared_mutex> writeLock(localAbilityMapLock_);
+    auto& record = GetSaRecordLocked(saId);
+    record.hasStartReason = true;
+    record.startReason = std::move(event);
+    record.mergedStartReasons.clear();
+}
+
 void LocalAbilityManager::SetStartReason(int32_t saId, const nlohmann::json& event)
 {
-    std::lock_guard<std::mutex> autoLock(ReasonLock_);
-    saIdToStartReason_[saId] = event;
+    SetStartReason(saId, JsonToOnDemandReason(event));
+}
+
+void LocalAbilityManager::SetMergedStartReasons(int32_t saId, std::vector<SystemAbilityOnDemandReason>&& events)
+{
+    if (events.empty()) {
+        return;
+    }
+    std::unique_lock<std::shared_mutex> writeLock(localAbilityMapLock_);
+    auto& record = GetSaRecordLocked(saId);
+    // OnStart is delivered the latest reason, the same one a single request would have left
+    record.hasStartReason = true;
+    record.startReason = events.back();
+    record.mergedStartReasons = std::move(events);
+}
+
+std::vector<SystemAbilityOnDemandReason> LocalAbilityManager::GetMergedStartReasons(int32_t saId)
+{
+    std::shared_lock<std::shared_mutex> readLock(localAbilityMapLock_);
+    auto record = FindSaRecordLocked(saId);
+    if (record == nullptr || !record->hasStartReason) {
+        return {};
+    }
+    if (!record->mergedStartReasons.empty()) {
+        return record->mergedStartReasons;
+    }
+    return {record->startReason};
+}
+
+void LocalAbilityManager::SetStopReason(int32_t saId, SystemAbilityOnDemandReason&& event)
+{
+    std::unique_lock<std::shared_mutex> writeLock(localAbilityMapLock_);
+    GetSaRecordLocked(saId).stopReason = std::move(event);
 }
 
 void LocalAbilityManager::SetStopReason(int32_t saId, const nlohmann::json& event)
 {
-    std::lock_guard<std::mutex> autoLock(ReasonLock_);
-    saIdToStopReason_[saId] = event;
+    SetStopReason(saId, JsonToOnDemandReason(event));
 }
 
-nlohmann::json LocalAbilityManager::GetStartReason(int32_t saId)
+SystemAbilityOnDemandReason LocalAbilityManager::GetStartReason(int32_t saId)
 {
-    std::lock_guard<std::mutex> autoLock(ReasonLock_);
-    return saIdToStartReason_[saId];
+    std::shared_lock<std::shared_mutex> readLock(localAbilityMapLock_);
+    auto record = FindSaRecordLocked(saId);
+    return (record != nullptr) ? record->startReason : SystemAbilityOnDemandReason();
 }
 
-nlohmann::json LocalAbilityManager::GetStopReason(int32_t saId)
+SystemAbilityOnDemandReason LocalAbilityManager::GetStopReason(int32_t saId)
 {
-    std::lock_guard<std::mutex> autoLock(ReasonLock_);
-    return saIdToStopReason_[saId];
+    std::shared_lock<std::shared_mutex> readLock(localAbilityMapLock_);
+    auto record = FindSaRecordLocked(saId);
+    return (record != nullptr) ? record->stopReason : SystemAbilityOnDemandReason();
 }
 
 sptr<ISystemAbilityStatusChange> LocalAbilityManager::GetSystemAbilityStatusChange()
@@ -963,11 +1925,20 @@ bool LocalAbilityManager::IpcStatCmdProc(int32_t fd, int32_t cmd)
     std::string result;
 
     HILOGI(TAG, "IpcStatCmdProc:fd=%{public}d cmd=%{public}d request", fd, cmd);
-    if (cmd < IPC_STAT_CMD_START || cmd >= IPC_STAT_CMD_MAX) {
+    if ((cmd < IPC_STAT_CMD_START || cmd >= IPC_STAT_CMD_MAX) && cmd != IPC_STAT_CMD_GET_CSV) {
         HILOGW(TAG, "para invalid, fd=%{public}d cmd=%{public}d", fd, cmd);
         return false;
     }
 
+    if (cmd == IPC_STAT_CMD_GET || cmd == IPC_STAT_CMD_GET_CSV) {
+        StatWriter writer(fd);
+        ret = LocalAbilityManagerDumper::WriteIpcStatistics(writer, cmd == IPC_STAT_CMD_GET_CSV);
+        if (!writer.Flush()) {
+            HILOGW(TAG, "save to fd failed");
+            return false;
+        }
+        return ret;
+    }
     switch (cmd) {
         case IPC_STAT_CMD_START: {
             ret = LocalAbilityManagerDumper::StartIpcStatistics(result);
@@ -977,10 +1948,6 @@ bool LocalAbilityManager::IpcStatCmdProc(int32_t fd, int32_t cmd)
             ret = LocalAbilityManagerDumper::StopIpcStatistics(result);
             break;
         }
-        case IPC_STAT_CMD_GET: {
-            ret = LocalAbilityManagerDumper::GetIpcStatistics(result);
-            break;
-        }
         default:
             return false;
     }
@@ -1008,31 +1975,146 @@ bool LocalAbilityManager::FfrtStatCmdProc(int32_t fd, int32_t cmd)
     return ret;
 }
 
+bool LocalAbilityManager::ListenerStatCmdProc(int32_t fd, int32_t cmd)
+{
+    HILOGI(TAG, "ListenerStatCmdProc:fd=%{public}d cmd=%{public}d request", fd, cmd);
+    std::string result;
+    switch (cmd) {
+        case LISTENER_STAT_CMD_GET: {
+            DumpListenerStatistics(result);
+            break;
+        }
+        case LISTENER_STAT_CMD_RESET: {
+            std::lock_guard<std::mutex> autoLock(listenerHandlerLock_);
+            for (auto& [listenerSaId, stat] : listenerStats_) {
+                stat->dispatch.Reset();
+                stat->queueing.Reset();
+                stat->slowCount.store(0, std::memory_order_relaxed);
+            }
+            result = "pid:" + ToString(getpid()) + " listener statistics reset\n";
+            break;
+        }
+        default:
+            HILOGW(TAG, "para invalid, fd=%{public}d cmd=%{public}d", fd, cmd);
+            return false;
+    }
+    if (!SaveStringToFd(fd, result)) {
+        HILOGW(TAG, "save to fd failed");
+        return false;
+    }
+    return true;
+}
+
+bool LocalAbilityManager::LifecycleMetricsCmdProc(int32_t fd, int32_t cmd)
+{
+    HILOGI(TAG, "LifecycleMetricsCmdProc:fd=%{public}d cmd=%{public}d request", fd, cmd);
+    std::string result = "pid:" + ToString(getpid()) + " ";
+    switch (cmd) {
+        case LIFECYCLE_METRICS_CMD_GET: {
+            SaMetrics::GetInstance().Dump(result);
+            break;
+        }
+        case LIFECYCLE_METRICS_CMD_RESET: {
+            SaMetrics::GetInstance().Reset();
+            result.append("SA lifecycle metrics reset\n");
+            break;
+        }
+        default:
+            HILOGW(TAG, "para invalid, fd=%{public}d cmd=%{public}d", fd, cmd);
+            return false;
+    }
+    if (!SaveStringToFd(fd, result)) {
+        HILOGW(TAG, "save to fd failed");
+        return false;
+    }
+    return true;
+}
+
+bool LocalAbilityManager::SafwkTaskStatCmdProc(int32_t fd, int32_t cmd)
+{
+    HILOGI(TAG, "SafwkTaskStatCmdProc:fd=%{public}d cmd=%{public}d request", fd, cmd);
+    std::string result = "pid:" + ToString(getpid()) + " ";
+    switch (cmd) {
+        case SAFWK_TASK_STAT_CMD_GET: {
+            FfrtTaskStats::GetInstance().Dump(result);
+            break;
+        }
+        case SAFWK_TASK_STAT_CMD_RESET: {
+            FfrtTaskStats::GetInstance().Reset();
+            result.append("safwk task statistics reset\n");
+            break;
+        }
+        default:
+            HILOGW(TAG, "para invalid, fd=%{public}d cmd=%{public}d", fd, cmd);
+            return false;
+    }
+    if (!SaveStringToFd(fd, result)) {
+        HILOGW(TAG, "save to fd failed");
+        return false;
+    }
+    return true;
+}
+
+void LocalAbilityManager::DumpListenerStatistics(std::string& result)
+{
+    std::vector<std::pair<int32_t, std::shared_ptr<ListenerStat>>> stats;
+    {
+        std::lock_guard<std::mutex> autoLock(listenerHandlerLock_);
+        stats.assign(listenerStats_.begin(), listenerStats_.end());
+    }
+    result.append("pid:" + ToString(getpid()) + " listener statistics(us), slow means over ");
+    result.append(ToString(MAX_LISTENER_NOTIFY_TIME) + "ms\n");
+    for (const auto& [listenerSaId, stat] : stats) {
+        result.append("listenerSA:" + ToString(listenerSaId));
+        result.append(" slow:" + ToString(stat->slowCount.load(std::memory_order_relaxed)) + "\n");
+        result.append("  dispatch ");
+        LatencyHistogram::FormatSummary(stat->dispatch.GetSummary(), result);
+        result.append("\n  queueing ");
+        LatencyHistogram::FormatSummary(stat->queueing.GetSummary(), result);
+        result.append("\n");
+    }
+}
+
 typedef void (*PGetSdkName)(uint32_t cmd, char *buf, uint32_t len);
 
-bool LocalAbilityManager::FfrtDumperProc(std::string& ffrtDumperInfo)
+static PGetSdkName GetFfrtDumpFunc()
 {
-    HILOGI(TAG, "FfrtDumperPorc request");
-    PGetSdkName pFFrtDumpInfo = (PGetSdkName)dlsym(RTLD_DEFAULT, "ffrt_dump");
+    // ffrt may be loaded after the first dump request, so only a resolved symbol is cached
+    static std::atomic<PGetSdkName> ffrtDumpFunc = nullptr;
+    PGetSdkName func = ffrtDumpFunc.load(std::memory_order_acquire);
+    if (func != nullptr) {
+        return func;
+    }
+    func = reinterpret_cast<PGetSdkName>(dlsym(RTLD_DEFAULT, "ffrt_dump"));
     char* pszErr = dlerror();
     if (pszErr != NULL) {
         HILOGE(TAG, "dlsym err info: %{public}s", pszErr);
     }
+    if (func != nullptr) {
+        ffrtDumpFunc.store(func, std::memory_order_release);
+    }
+    return func;
+}
+
+bool LocalAbilityManager::FfrtDumperProc(std::string& ffrtDumperInfo)
+{
+    HILOGI(TAG, "FfrtDumperPorc request");
+    PGetSdkName pFFrtDumpInfo = GetFfrtDumpFunc();
     if (pFFrtDumpInfo == NULL) {
         HILOGE(TAG, "dlsym failed");
         ffrtDumperInfo.append("process " + std::to_string(getpid()) + " did not load ffrt\n");
         return false;
     }
-    char* buffer = new char[FFRT_BUFFER_SIZE + 1]();
-    buffer[FFRT_BUFFER_SIZE] = 0;
-    (*pFFrtDumpInfo)(FFRT_DUMP_INFO_ALL, buffer, FFRT_BUFFER_SIZE);
-    if (strlen(buffer) == 0) {
+    // left uninitialized, only the bytes ffrt writes are read, and freed when the dump returns
+    std::unique_ptr<char[]> buffer(new char[FFRT_BUFFER_SIZE]);
+    buffer[0] = '\0';
+    (*pFFrtDumpInfo)(FFRT_DUMP_INFO_ALL, buffer.get(), FFRT_BUFFER_SIZE);
+    size_t len = strnlen(buffer.get(), FFRT_BUFFER_SIZE);
+    if (len == 0) {
         HILOGE(TAG, "get samgr FfrtDumperInfo failed");
-        delete[] buffer;
         return false;
     }
-    ffrtDumperInfo += buffer;
-    delete[] buffer;
+    ffrtDumperInfo.append(buffer.get(), len);
     return true;
 }
 
@@ -1052,11 +2134,22 @@ int32_t LocalAbilityManager::SystemAbilityExtProc(const std::string& extension,
     return ability->OnExtension(extension, *callback->data_, *callback->reply_);
 }
 
+int32_t LocalAbilityManager::SystemAbilityExtProcAsync(const std::string& extension, int32_t said,
+    MessageParcel& data, const std::shared_ptr<SystemAbilityExtensionReply>& reply)
+{
+    HILOGD(TAG, "SystemAbilityExtProcAsync Extension %{public}s SA:%{public}d", extension.c_str(), said);
+    auto ability = GetAbility(said);
+    if (ability == nullptr) {
+        return INVALID_DATA;
+    }
+    return ability->OnExtensionAsync(extension, data, reply);
+}
+
 bool LocalAbilityManager::IsResident()
 {
     std::shared_lock<std::shared_mutex> readLock(localAbilityMapLock_);
-    for (const auto& it : localAbilityMap_) {
-        if ((it.second != nullptr) && (it.second->IsRunOnCreate())) {
+    for (const auto& record : saRecords_) {
+        if ((record.ability != nullptr) && (record.ability->IsRunOnCreate())) {
             return true;
         }
     }
@@ -1071,19 +2164,34 @@ bool LocalAbilityManager::NoNeedCheckUnused(int32_t saId)
 
 bool LocalAbilityManager::IsConfigUnused()
 {
-    HILOGI(TAG, "unusedCfgMap_ size:%{public}zu", unusedCfgMap_.size());
-    return !unusedCfgMap_.empty();
+    size_t unusedCfgNum = GetUnusedCfgs().size();
+    HILOGI(TAG, "unused cfg size:%{public}zu", unusedCfgNum);
+    return unusedCfgNum != 0;
+}
+
+std::vector<std::pair<int32_t, int32_t>> LocalAbilityManager::GetUnusedCfgs()
+{
+    std::vector<std::pair<int32_t, int32_t>> unusedCfgs;
+    std::shared_lock<std::shared_mutex> readLock(localAbilityMapLock_);
+    for (const auto& record : saRecords_) {
+        if (record.unusedTimeout > 0) {
+            unusedCfgs.emplace_back(record.saId, record.unusedTimeout);
+        }
+    }
+    return unusedCfgs;
 }
 
 void LocalAbilityManager::LimitUnusedTimeout(int32_t saId, int32_t timeout)
 {
     int64_t millisecTimeout = static_cast<int64_t>(timeout * TIME_S_TO_MS);
+    std::unique_lock<std::shared_mutex> writeLock(localAbilityMapLock_);
+    auto& record = GetSaRecordLocked(saId);
     if (millisecTimeout < ONDEMAND_SA_UNUSED_TIMEOUT_LOWLIMIT) {
-        unusedCfgMap_[saId] = ONDEMAND_SA_UNUSED_TIMEOUT_LOWLIMIT;
+        record.unusedTimeout = ONDEMAND_SA_UNUSED_TIMEOUT_LOWLIMIT;
     } else if (millisecTimeout > ONDEMAND_SA_UNUSED_TIMEOUT_UPLIMIT) {
-        unusedCfgMap_[saId] = ONDEMAND_SA_UNUSED_TIMEOUT_UPLIMIT;
+        record.unusedTimeout = ONDEMAND_SA_UNUSED_TIMEOUT_UPLIMIT;
     } else {
-        unusedCfgMap_[saId] = millisecTimeout;
+        record.unusedTimeout = static_cast<int32_t>(millisecTimeout);
     }
 }
 
@@ -1130,7 +2238,7 @@ void LocalAbilityManager::IdentifyUnusedOndemand()
         return;
     }
 
-    for (const auto& it : unusedCfgMap_) {
+    for (const auto& it : GetUnusedCfgs()) {
         int32_t saId = it.first;
         uint64_t lastRequestTime;
         bool ret = GetSaLastRequestTime(saId, lastRequestTime);
@@ -1167,9 +2275,12 @@ void LocalAbilityManager::StartTimedQuery()
 {
     {
         std::shared_lock<std::shared_mutex> readLock(localAbilityMapLock_);
-        for (const auto& it : localAbilityMap_) {
-            if (NoNeedCheckUnused(it.first)) {
-                HILOGI(TAG, "SA:%{public}d no need check unused", it.first);
+        for (const auto& record : saRecords_) {
+            if (record.ability == nullptr) {
+                continue;
+            }
+            if (NoNeedCheckUnused(record.saId)) {
+                HILOGI(TAG, "SA:%{public}d no need check unused", record.saId);
                 return;
             }
         }
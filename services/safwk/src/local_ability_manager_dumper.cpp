@@ -14,12 +14,19 @@
  */
 #include "local_ability_manager_dumper.h"
 #include "ffrt_inner.h"
+#include "ffrt_task_stats.h"
 #include "safwk_log.h"
 
 #include "vector"
 #include "unistd.h"
 #include "string_ex.h"
 #include "ipc_payload_statistics.h"
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
 
 namespace OHOS {
 namespace {
@@ -29,6 +36,8 @@ constexpr int32_t COLLECT_FFRT_METRIC_MAX_SIZE = 5000;
 constexpr int32_t FFRT_STAT_SIZE = sizeof(ffrt_stat);
 constexpr int32_t BUFFER_SIZE = FFRT_STAT_SIZE * COLLECT_FFRT_METRIC_MAX_SIZE;
 constexpr int32_t DELAY_TIME = 60 * 1000;
+constexpr size_t TOP_TASK_NAME_NUM = 10;
+constexpr const char* IPC_STAT_CSV_HEADER = "pid,callingPid,descriptor,code,count,totalCost,maxCost,minCost,avgCost\n";
 }
 
 std::shared_ptr<FFRTHandler> LocalAbilityManagerDumper::handler_ = nullptr;
@@ -54,53 +63,64 @@ bool LocalAbilityManagerDumper::StopIpcStatistics(std::string& result)
 
 bool LocalAbilityManagerDumper::GetIpcStatistics(std::string& result)
 {
-    result += "********************************GlobalStatisticsInfo********************************";
-    result += "\nCurrentPid:";
-    result += std::to_string(getpid());
-    result += "\nTotalCount:";
-    result += std::to_string(IPCPayloadStatistics::GetTotalCount());
-    result += "\nTotalTimeCost:";
-    result += std::to_string(IPCPayloadStatistics::GetTotalCost());
-    std::vector<int32_t> pids;
-    pids = IPCPayloadStatistics::GetPids();
-    for (unsigned int i = 0; i < pids.size(); i++) {
-        result += "\n--------------------------------ProcessStatisticsInfo-------------------------------";
-        result += "\nCallingPid:";
-        result += std::to_string(pids[i]);
-        result += "\nCallingPidTotalCount:";
-        result += std::to_string(IPCPayloadStatistics::GetCount(pids[i]));
-        result += "\nCallingPidTotalTimeCost:";
-        result += std::to_string(IPCPayloadStatistics::GetCost(pids[i]));
-        std::vector<IPCInterfaceInfo> intfs;
-        intfs = IPCPayloadStatistics::GetDescriptorCodes(pids[i]);
-        for (unsigned int j = 0; j < intfs.size(); j++) {
-            result += "\n~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~InterfaceStatisticsInfo~~~~~~~~~~~~~~~~~~~~~~~~~~~~~";
-            result += "\nDescriptorCode:";
-            result += Str16ToStr8(intfs[j].desc) + std::string("_") + std::to_string(intfs[j].code);
-            result += "\nDescriptorCodeCount:";
-            result += std::to_string(
-                IPCPayloadStatistics::GetDescriptorCodeCount(pids[i], intfs[j].desc, intfs[j].code));
-            result += "\nDescriptorCodeTimeCost:";
-            result += "\nTotal:";
-            result += std::to_string(
-                IPCPayloadStatistics::GetDescriptorCodeCost(pids[i], intfs[j].desc, intfs[j].code).totalCost);
-            result += " | Max:";
-            result += std::to_string(
-                IPCPayloadStatistics::GetDescriptorCodeCost(pids[i], intfs[j].desc, intfs[j].code).maxCost);
-            result += " | Min:";
-            result += std::to_string(
-                IPCPayloadStatistics::GetDescriptorCodeCost(pids[i], intfs[j].desc, intfs[j].code).minCost);
-            result += " | Avg:";
-            result += std::to_string(
-                IPCPayloadStatistics::GetDescriptorCodeCost(pids[i], intfs[j].desc, intfs[j].code).averCost);
-            result += "\n~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~";
+    StatWriter writer(result);
+    return WriteIpcStatistics(writer, false);
+}
+
+bool LocalAbilityManagerDumper::WriteIpcStatistics(StatWriter& writer, bool csv)
+{
+    if (csv) {
+        WriteIpcStatisticsCsv(writer);
+        return true;
+    }
+    writer.Append("********************************GlobalStatisticsInfo********************************");
+    writer.Append("\nCurrentPid:").AppendNumber(getpid());
+    writer.Append("\nTotalCount:").AppendNumber(IPCPayloadStatistics::GetTotalCount());
+    writer.Append("\nTotalTimeCost:").AppendNumber(IPCPayloadStatistics::GetTotalCost());
+    std::vector<int32_t> pids = IPCPayloadStatistics::GetPids();
+    for (int32_t pid : pids) {
+        writer.Append("\n--------------------------------ProcessStatisticsInfo-------------------------------");
+        writer.Append("\nCallingPid:").AppendNumber(pid);
+        writer.Append("\nCallingPidTotalCount:").AppendNumber(IPCPayloadStatistics::GetCount(pid));
+        writer.Append("\nCallingPidTotalTimeCost:").AppendNumber(IPCPayloadStatistics::GetCost(pid));
+        std::vector<IPCInterfaceInfo> intfs = IPCPayloadStatistics::GetDescriptorCodes(pid);
+        for (const auto& intf : intfs) {
+            IPCPayloadCost cost = IPCPayloadStatistics::GetDescriptorCodeCost(pid, intf.desc, intf.code);
+            writer.Append("\n~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~InterfaceStatisticsInfo~~~~~~~~~~~~~~~~~~~~~~~~~~~~~");
+            writer.Append("\nDescriptorCode:").Append(Str16ToStr8(intf.desc)).Append('_').AppendNumber(intf.code);
+            writer.Append("\nDescriptorCodeCount:")
+                .AppendNumber(IPCPayloadStatistics::GetDescriptorCodeCount(pid, intf.desc, intf.code));
+            writer.Append("\nDescriptorCodeTimeCost:");
+            writer.Append("\nTotal:").AppendNumber(cost.totalCost);
+            writer.Append(" | Max:").AppendNumber(cost.maxCost);
+            writer.Append(" | Min:").AppendNumber(cost.minCost);
+            writer.Append(" | Avg:").AppendNumber(cost.averCost);
+            writer.Append("\n~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~");
         }
-        result += "\n------------------------------------------------------------------------------------";
+        writer.Append("\n------------------------------------------------------------------------------------");
     }
-    result += "\n************************************************************************************\n";
+    writer.Append("\n************************************************************************************\n");
     return true;
 }
 
+void LocalAbilityManagerDumper::WriteIpcStatisticsCsv(StatWriter& writer)
+{
+    writer.Append(IPC_STAT_CSV_HEADER);
+    int32_t currentPid = getpid();
+    std::vector<int32_t> pids = IPCPayloadStatistics::GetPids();
+    for (int32_t pid : pids) {
+        std::vector<IPCInterfaceInfo> intfs = IPCPayloadStatistics::GetDescriptorCodes(pid);
+        for (const auto& intf : intfs) {
+            IPCPayloadCost cost = IPCPayloadStatistics::GetDescriptorCodeCost(pid, intf.desc, intf.code);
+            writer.AppendNumber(currentPid).Append(',').AppendNumber(pid).Append(',');
+            writer.AppendCsvField(Str16ToStr8(intf.desc)).Append(',').AppendNumber(intf.code).Append(',');
+            writer.AppendNumber(IPCPayloadStatistics::GetDescriptorCodeCount(pid, intf.desc, intf.code)).Append(',');
+            writer.AppendNumber(cost.totalCost).Append(',').AppendNumber(cost.maxCost).Append(',');
+            writer.AppendNumber(cost.minCost).Append(',').AppendNumber(cost.averCost).Append('\n');
+        }
+    }
+}
+
 bool LocalAbilityManagerDumper::StartFfrtStatistics(std::string& result)
 {
     if (collectEnable) {
@@ -168,6 +188,8 @@ void LocalAbilityManagerDumper::FfrtStatisticsParser(std::string& result)
     uint64_t sumTime = 0;
     uint64_t avgTime = 0;
     uint64_t count = 0;
+    // keys point into ffrtMetricBuffer, which outlives the parse
+    std::unordered_map<std::string_view, LatencyHistogram> taskStats;
     while ((char*)currentStat < lastStat && std::strcmp(currentStat->taskName, "") != 0) {
         if (currentStat->startTime > currentStat->endTime) {
             currentStat = (ffrt_stat*)((char*)currentStat + FFRT_STAT_SIZE);
@@ -178,6 +200,8 @@ void LocalAbilityManagerDumper::FfrtStatisticsParser(std::string& result)
         maxTime = std::max(maxTime, duration);
         minTime = std::min(minTime, duration);
         ++count;
+        taskStats[std::string_view(currentStat->taskName, strnlen(currentStat->taskName,
+            sizeof(currentStat->taskName)))].Record(duration);
         taskInfo.append(currentStat->taskName);
         taskInfo.append(" " + ToString(currentStat->startTime));
         taskInfo.append(" " + ToString(currentStat->endTime) + "\n");
@@ -191,6 +215,7 @@ void LocalAbilityManagerDumper::FfrtStatisticsParser(std::string& result)
     result.append("sumTime:" + ToString(sumTime) + " maxTime:" + ToString(maxTime));
     result.append(" minTime:" + ToString(minTime) + " avgTime:" + ToString(avgTime));
     result.append(" cntTime:" + ToString(count) + "\n");
+    FfrtTopTasksParser(taskStats, result);
     result.append("-------------------------------------------------------------------------------------------\n");
     result.append("taskName                                                        startTime(us)   endTime(us)\n");
     result.append("-------------------------------------------------------------------------------------------\n");
@@ -198,6 +223,20 @@ void LocalAbilityManagerDumper::FfrtStatisticsParser(std::string& result)
     result.append("-------------------------------------------------------------------------------------------\n");
 }
 
+void LocalAbilityManagerDumper::FfrtTopTasksParser(
+    const std::unordered_map<std::string_view, LatencyHistogram>& taskStats, std::string& result)
+{
+    std::vector<FfrtTaskStats::TaskSummary> summaries;
+    summaries.reserve(taskStats.size());
+    for (const auto& [name, histogram] : taskStats) {
+        summaries.emplace_back(name, histogram.GetSummary());
+    }
+    size_t topNum = std::min(summaries.size(), TOP_TASK_NAME_NUM);
+    result.append("-------------------------------------------------------------------------------------------\n");
+    result.append("top " + ToString(topNum) + " of " + ToString(summaries.size()) + " taskNames by sumTime(us)\n");
+    FfrtTaskStats::AppendTaskSummaries(summaries, topNum, result);
+}
+
 void LocalAbilityManagerDumper::ClearFfrtStatisticsBufferLocked()
 {
     if (ffrtMetricBuffer != nullptr) {
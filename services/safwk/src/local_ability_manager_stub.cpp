@@ -15,7 +15,9 @@
 
 #include "local_ability_manager_stub.h"
 
+#include <array>
 #include <cstdint>
+#include <limits>
 #include <utility>
 #include <cinttypes>
 
@@ -25,10 +27,12 @@
 #include "ipc_types.h"
 #include "message_option.h"
 #include "message_parcel.h"
-#include "parse_util.h"
 #include "safwk_log.h"
 #include "datetime_ex.h"
 #include "system_ability_definition.h"
+#include "sa_lifecycle_command.h"
+#include "system_ability_extension_reply.h"
+#include "system_ability_ondemand_reason.h"
 #include "ipc_skeleton.h"
 #include "accesstoken_kit.h"
 
@@ -39,47 +43,297 @@ namespace {
 const std::string PERMISSION_EXT_TRANSACTION = "ohos.permission.ACCESS_EXT_SYSTEM_ABILITY";
 const std::string PERMISSION_MANAGE = "ohos.permission.MANAGE_SYSTEM_ABILITY";
 const std::string PERMISSION_SVC = "ohos.permission.CONTROL_SVC_CMD";
+constexpr const char* EVENT_ID = "eventId";
+constexpr const char* NAME = "name";
+constexpr const char* VALUE = "value";
+constexpr const char* EXTRA_DATA_ID = "extraDataId";
+constexpr size_t PERMISSION_CACHE_SIZE = 8;
+constexpr int64_t PERMISSION_CACHE_EXPIRE_TIME = 3000;
+constexpr uint32_t BINARY_CODE_BASE = static_cast<uint32_t>(SafwkBinaryInterfaceCode::QUERY_PROTOCOL_TRANSACTION);
+
+template <typename Handler>
+struct StubCodeEntry {
+    template <typename Code>
+    constexpr StubCodeEntry(Code entryCode, Handler entryHandler)
+        : code(static_cast<uint32_t>(entryCode)), handler(entryHandler) {}
+    uint32_t code;
+    Handler handler;
+};
+
+template <typename Handler, size_t N>
+constexpr size_t DenseTableSize(const StubCodeEntry<Handler> (&entries)[N], uint32_t base)
+{
+    size_t size = 0;
+    for (const auto& entry : entries) {
+        if (entry.code >= base && entry.code - base + 1 > size) {
+            size = entry.code - base + 1;
+        }
+    }
+    return size;
 }
 
-LocalAbilityManagerStub::LocalAbilityManagerStub()
-{
-    memberFuncMap_[static_cast<uint32_t>(SafwkInterfaceCode::START_ABILITY_TRANSACTION)] =
-        LocalAbilityManagerStub::LocalStartAbility;
-    memberFuncMap_[static_cast<uint32_t>(SafwkInterfaceCode::STOP_ABILITY_TRANSACTION)] =
-        LocalAbilityManagerStub::LocalStopAbility;
-    memberFuncMap_[static_cast<uint32_t>(SafwkInterfaceCode::ACTIVE_ABILITY_TRANSACTION)] =
-        LocalAbilityManagerStub::LocalActiveAbility;
-    memberFuncMap_[static_cast<uint32_t>(SafwkInterfaceCode::IDLE_ABILITY_TRANSACTION)] =
-        LocalAbilityManagerStub::LocalIdleAbility;
-    memberFuncMap_[static_cast<uint32_t>(SafwkInterfaceCode::SEND_STRATEGY_TO_SA_TRANSACTION)] =
-        LocalAbilityManagerStub::LocalSendStrategyToSA;
-    memberFuncMap_[static_cast<uint32_t>(SafwkInterfaceCode::IPC_STAT_CMD_TRANSACTION)] =
-        LocalAbilityManagerStub::LocalIpcStatCmdProc;
-    memberFuncMap_[static_cast<uint32_t>(SafwkInterfaceCode::FFRT_DUMPER_TRANSACTION)] =
-        LocalAbilityManagerStub::LocalFfrtDumperProc;
-    memberFuncMap_[static_cast<uint32_t>(SafwkInterfaceCode::SYSTEM_ABILITY_EXT_TRANSACTION)] =
-        LocalAbilityManagerStub::LocalSystemAbilityExtProc;
-    memberFuncMap_[static_cast<uint32_t>(SafwkInterfaceCode::FFRT_STAT_CMD_TRANSACTION)] =
-        LocalAbilityManagerStub::LocalFfrtStatCmdProc;
-    memberFuncMap_[static_cast<uint32_t>(SafwkInterfaceCode::SERVICE_CONTROL_CMD_TRANSACTION)] =
-        LocalAbilityManagerStub::LocalServiceControlCmd;
+// Slots of codes without an entry keep a null func, so a lookup is one bounds check and one indexed load.
+template <size_t SIZE, typename Handler, size_t N>
+constexpr std::array<Handler, SIZE> MakeDenseTable(const StubCodeEntry<Handler> (&entries)[N], uint32_t base)
+{
+    std::array<Handler, SIZE> table {};
+    for (const auto& entry : entries) {
+        if (entry.code >= base && entry.code - base < SIZE) {
+            table[entry.code - base] = entry.handler;
+        }
+    }
+    return table;
 }
 
-bool LocalAbilityManagerStub::CheckPermission(uint32_t code)
+class PermissionChangeCallback : public Security::AccessToken::PermStateChangeCallbackCustomize {
+public:
+    explicit PermissionChangeCallback(const Security::AccessToken::PermStateChangeScope& scope)
+        : PermStateChangeCallbackCustomize(scope) {}
+    void PermStateChangeCallback(Security::AccessToken::PermStateChangeInfo& result) override
+    {
+        HILOGI(TAG, "perm:%{public}s changed, token:%{public}u", result.permissionName.c_str(), result.tokenID);
+        PermissionVerdictCache::GetInstance().Invalidate();
+    }
+};
+
+class OnDemandReasonSaxHandler : public nlohmann::json_sax<nlohmann::json> {
+public:
+    explicit OnDemandReasonSaxHandler(SystemAbilityOnDemandReason& reason) : reason_(reason) {}
+
+    bool null() override
+    {
+        field_ = Field::NONE;
+        return true;
+    }
+    bool boolean(bool) override
+    {
+        field_ = Field::NONE;
+        return true;
+    }
+    bool number_integer(number_integer_t val) override
+    {
+        return SetNumber(static_cast<int64_t>(val));
+    }
+    bool number_unsigned(number_unsigned_t val) override
+    {
+        return SetNumber(static_cast<int64_t>(val));
+    }
+    bool number_float(number_float_t val, const string_t&) override
+    {
+        if (depth_ != 1 || (field_ != Field::EVENT_ID && field_ != Field::EXTRA_DATA_ID)) {
+            field_ = Field::NONE;
+            return true;
+        }
+        // the string comes from an IPC peer, a reason field without an int64 value fails the parse
+        if (val < static_cast<number_float_t>(std::numeric_limits<int64_t>::min()) ||
+            val >= static_cast<number_float_t>(std::numeric_limits<int64_t>::max())) {
+            return false;
+        }
+        return SetNumber(static_cast<int64_t>(val));
+    }
+    bool string(string_t& val) override
+    {
+        if (depth_ == 1 && field_ == Field::NAME) {
+            reason_.SetName(val);
+        } else if (depth_ == 1 && field_ == Field::VALUE) {
+            reason_.SetValue(val);
+        }
+        field_ = Field::NONE;
+        return true;
+    }
+    bool binary(binary_t&) override
+    {
+        field_ = Field::NONE;
+        return true;
+    }
+    bool start_object(std::size_t) override
+    {
+        field_ = Field::NONE;
+        ++depth_;
+        return true;
+    }
+    bool key(string_t& val) override
+    {
+        // only the top level keys describe the reason
+        if (depth_ != 1) {
+            field_ = Field::NONE;
+        } else if (val == EVENT_ID) {
+            field_ = Field::EVENT_ID;
+        } else if (val == NAME) {
+            field_ = Field::NAME;
+        } else if (val == VALUE) {
+            field_ = Field::VALUE;
+        } else if (val == EXTRA_DATA_ID) {
+            field_ = Field::EXTRA_DATA_ID;
+        } else {
+            field_ = Field::NONE;
+        }
+        return true;
+    }
+    bool end_object() override
+    {
+        --depth_;
+        return true;
+    }
+    bool start_array(std::size_t) override
+    {
+        field_ = Field::NONE;
+        ++depth_;
+        return true;
+    }
+    bool end_array() override
+    {
+        --depth_;
+        return true;
+    }
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override
+    {
+        return false;
+    }
+
+private:
+    enum class Field {
+        NONE,
+        EVENT_ID,
+        NAME,
+        VALUE,
+        EXTRA_DATA_ID,
+    };
+    bool SetNumber(int64_t val)
+    {
+        if (depth_ == 1 && field_ == Field::EVENT_ID) {
+            reason_.SetId(static_cast<OnDemandReasonId>(val));
+        } else if (depth_ == 1 && field_ == Field::EXTRA_DATA_ID) {
+            reason_.SetExtraDataId(val);
+        }
+        field_ = Field::NONE;
+        return true;
+    }
+
+    SystemAbilityOnDemandReason& reason_;
+    Field field_ = Field::NONE;
+    int32_t depth_ = 0;
+};
+
+nlohmann::json OnDemandReasonToJson(const SystemAbilityOnDemandReason& reason)
+{
+    nlohmann::json reasonJson;
+    reasonJson[EVENT_ID] = static_cast<int32_t>(reason.GetId());
+    reasonJson[NAME] = reason.GetName();
+    reasonJson[VALUE] = reason.GetValue();
+    reasonJson[EXTRA_DATA_ID] = reason.GetExtraDataId();
+    return reasonJson;
+}
+}
+
+const LocalAbilityManagerStub::StubHandler* LocalAbilityManagerStub::GetStubHandler(uint32_t code)
 {
-    uint32_t accessToken = IPCSkeleton::GetCallingTokenID();
-    std::string permissionToCheck;
+    using Entry = StubCodeEntry<StubHandler>;
+    static constexpr Entry SAFWK_ENTRIES[] = {
+        { SafwkInterfaceCode::START_ABILITY_TRANSACTION, { LocalStartAbility, &PERMISSION_MANAGE } },
+        { SafwkInterfaceCode::STOP_ABILITY_TRANSACTION, { LocalStopAbility, &PERMISSION_MANAGE } },
+        { SafwkInterfaceCode::ACTIVE_ABILITY_TRANSACTION, { LocalActiveAbility, &PERMISSION_MANAGE } },
+        { SafwkInterfaceCode::IDLE_ABILITY_TRANSACTION, { LocalIdleAbility, &PERMISSION_MANAGE } },
+        { SafwkInterfaceCode::SEND_STRATEGY_TO_SA_TRANSACTION, { LocalSendStrategyToSA, &PERMISSION_MANAGE } },
+        { SafwkInterfaceCode::IPC_STAT_CMD_TRANSACTION, { LocalIpcStatCmdProc, &PERMISSION_MANAGE } },
+        { SafwkInterfaceCode::FFRT_DUMPER_TRANSACTION, { LocalFfrtDumperProc, &PERMISSION_MANAGE } },
+        { SafwkInterfaceCode::SYSTEM_ABILITY_EXT_TRANSACTION,
+            { LocalSystemAbilityExtProc, &PERMISSION_EXT_TRANSACTION } },
+        { SafwkInterfaceCode::FFRT_STAT_CMD_TRANSACTION, { LocalFfrtStatCmdProc, &PERMISSION_MANAGE } },
+        { SafwkInterfaceCode::SERVICE_CONTROL_CMD_TRANSACTION, { LocalServiceControlCmd, &PERMISSION_SVC } },
+    };
+    static constexpr Entry BINARY_ENTRIES[] = {
+        { SafwkBinaryInterfaceCode::QUERY_PROTOCOL_TRANSACTION, { LocalQueryProtocol, &PERMISSION_MANAGE } },
+        { SafwkBinaryInterfaceCode::START_ABILITY_BINARY_TRANSACTION, { LocalStartAbilityBinary, &PERMISSION_MANAGE } },
+        { SafwkBinaryInterfaceCode::STOP_ABILITY_BINARY_TRANSACTION, { LocalStopAbilityBinary, &PERMISSION_MANAGE } },
+        { SafwkBinaryInterfaceCode::ACTIVE_ABILITY_BINARY_TRANSACTION,
+            { LocalActiveAbilityBinary, &PERMISSION_MANAGE } },
+        { SafwkBinaryInterfaceCode::IDLE_ABILITY_BINARY_TRANSACTION, { LocalIdleAbilityBinary, &PERMISSION_MANAGE } },
+        { SafwkBinaryInterfaceCode::BATCH_LIFECYCLE_TRANSACTION, { LocalBatchLifecycle, &PERMISSION_MANAGE } },
+        { SafwkBinaryInterfaceCode::SYSTEM_ABILITY_EXT_ASYNC_TRANSACTION,
+            { LocalSystemAbilityExtAsync, &PERMISSION_EXT_TRANSACTION } },
+        { SafwkBinaryInterfaceCode::LISTENER_STAT_CMD_TRANSACTION, { LocalListenerStatCmdProc, &PERMISSION_MANAGE } },
+        { SafwkBinaryInterfaceCode::LIFECYCLE_METRICS_CMD_TRANSACTION,
+            { LocalLifecycleMetricsCmdProc, &PERMISSION_MANAGE } },
+        { SafwkBinaryInterfaceCode::SAFWK_TASK_STAT_CMD_TRANSACTION,
+            { LocalSafwkTaskStatCmdProc, &PERMISSION_MANAGE } },
+    };
+    static constexpr auto SAFWK_TABLE = MakeDenseTable<DenseTableSize(SAFWK_ENTRIES, 0)>(SAFWK_ENTRIES, 0);
+    static constexpr auto BINARY_TABLE = MakeDenseTable<DenseTableSize(BINARY_ENTRIES, BINARY_CODE_BASE)>(
+        BINARY_ENTRIES, BINARY_CODE_BASE);
 
-    if (code == static_cast<uint32_t>(SafwkInterfaceCode::SYSTEM_ABILITY_EXT_TRANSACTION)) {
-        permissionToCheck = PERMISSION_EXT_TRANSACTION;
-    } else if (code == static_cast<uint32_t>(SafwkInterfaceCode::SERVICE_CONTROL_CMD_TRANSACTION)) {
-        permissionToCheck = PERMISSION_SVC;
-    } else {
-        permissionToCheck = PERMISSION_MANAGE;
+    const StubHandler* handler = nullptr;
+    if (code < SAFWK_TABLE.size()) {
+        handler = &SAFWK_TABLE[code];
+    } else if (code >= BINARY_CODE_BASE && code - BINARY_CODE_BASE < BINARY_TABLE.size()) {
+        handler = &BINARY_TABLE[code - BINARY_CODE_BASE];
     }
+    return (handler != nullptr && handler->func != nullptr) ? handler : nullptr;
+}
 
-    int32_t ret = Security::AccessToken::AccessTokenKit::VerifyAccessToken(accessToken, permissionToCheck);
-    return ret == static_cast<int32_t>(Security::AccessToken::PermissionState::PERMISSION_GRANTED);
+PermissionVerdictCache::PermissionVerdictCache() : verdicts_(PERMISSION_CACHE_SIZE, PERMISSION_CACHE_EXPIRE_TIME)
+{
+}
+
+PermissionVerdictCache& PermissionVerdictCache::GetInstance()
+{
+    static PermissionVerdictCache instance;
+    return instance;
+}
+
+bool PermissionVerdictCache::Subscribe()
+{
+    if (callback_ != nullptr) {
+        return true;
+    }
+    Security::AccessToken::PermStateChangeScope scope;
+    scope.permList = { PERMISSION_MANAGE, PERMISSION_EXT_TRANSACTION, PERMISSION_SVC };
+    auto callback = std::make_shared<PermissionChangeCallback>(scope);
+    int32_t ret = Security::AccessToken::AccessTokenKit::RegisterPermStateChangeCallback(callback);
+    if (ret != ERR_OK) {
+        HILOGI(TAG, "register perm change callback:%{public}d, verdicts not cached", ret);
+        return false;
+    }
+    callback_ = callback;
+    enabled_.store(true, std::memory_order_release);
+    return true;
+}
+
+bool PermissionVerdictCache::Verify(uint32_t tokenId, const std::string& permission)
+{
+    if (!enabled_.load(std::memory_order_acquire)) {
+        int32_t ret = Security::AccessToken::AccessTokenKit::VerifyAccessToken(tokenId, permission);
+        return ret == static_cast<int32_t>(Security::AccessToken::PermissionState::PERMISSION_GRANTED);
+    }
+    auto key = std::make_pair(tokenId, reinterpret_cast<uintptr_t>(&permission));
+    if (verdicts_.Get(key) != nullptr) {
+        return true;
+    }
+    uint64_t generation = generation_.load(std::memory_order_acquire);
+    int32_t ret = Security::AccessToken::AccessTokenKit::VerifyAccessToken(tokenId, permission);
+    bool granted = (ret == static_cast<int32_t>(Security::AccessToken::PermissionState::PERMISSION_GRANTED));
+    // a change notified while verifying may already cover this verdict, so it is not kept
+    if (granted && generation == generation_.load(std::memory_order_acquire)) {
+        verdicts_.Add(key, true);
+    }
+    return granted;
+}
+
+void PermissionVerdictCache::Invalidate()
+{
+    generation_.fetch_add(1, std::memory_order_acq_rel);
+    verdicts_.Clear();
+}
+
+bool LocalAbilityManagerStub::VerifyPermission(const std::string& permission)
+{
+    return PermissionVerdictCache::GetInstance().Verify(IPCSkeleton::GetCallingTokenID(), permission);
+}
+
+bool LocalAbilityManagerStub::CheckPermission(uint32_t code)
+{
+    const StubHandler* handler = GetStubHandler(code);
+    return VerifyPermission(handler != nullptr ? *handler->permission : PERMISSION_MANAGE);
 }
 
 int32_t LocalAbilityManagerStub::OnRemoteRequest(uint32_t code,
@@ -91,16 +345,16 @@ int32_t LocalAbilityManagerStub::OnRemoteRequest(uint32_t code,
         return ERR_PERMISSION_DENIED;
     }
 
-    if (CheckPermission(code) == false) {
+    const StubHandler* handler = GetStubHandler(code);
+    if (!VerifyPermission(handler != nullptr ? *handler->permission : PERMISSION_MANAGE)) {
         HILOGW(TAG, "check permission failed! code:%{public}u, callingPid:%{public}d, callingTokenId:%{public}u",
             code, IPCSkeleton::GetCallingPid(), IPCSkeleton::GetCallingTokenID());
         return ERR_PERMISSION_DENIED;
     }
     HILOGD(TAG, "check permission success!");
 
-    auto iter = memberFuncMap_.find(code);
-    if (iter != memberFuncMap_.end()) {
-        return iter->second(this, data, reply);
+    if (handler != nullptr) {
+        return handler->func(this, data, reply);
     }
     HILOGW(TAG, "unknown request code!");
     return IPCObjectStub::OnRemoteRequest(code, data, reply, option);
@@ -165,8 +419,11 @@ int32_t LocalAbilityManagerStub::ActiveAbilityInner(MessageParcel& data, Message
         return ERR_NULL_OBJECT;
     }
     int64_t begin = GetTickCount();
-    nlohmann::json activeReason = ParseUtil::StringToJsonObj(data.ReadString());
-    bool result = ActiveAbility(saId, activeReason);
+    SystemAbilityOnDemandReason activeReason;
+    if (!ParseOnDemandReason(data.ReadString(), activeReason)) {
+        HILOGW(TAG, "ActiveAbilityInner parse reason failed!");
+    }
+    bool result = ActiveAbilityWithReason(saId, activeReason);
     if (!reply.WriteBool(result)) {
         HILOGW(TAG, "ActiveAbilityInner Write result failed!");
         return ERR_NULL_OBJECT;
@@ -188,9 +445,12 @@ int32_t LocalAbilityManagerStub::IdleAbilityInner(MessageParcel& data, MessagePa
         return ERR_NULL_OBJECT;
     }
     int64_t begin = GetTickCount();
-    nlohmann::json idleReason = ParseUtil::StringToJsonObj(data.ReadString());
+    SystemAbilityOnDemandReason idleReason;
+    if (!ParseOnDemandReason(data.ReadString(), idleReason)) {
+        HILOGW(TAG, "IdleAbilityInner parse reason failed!");
+    }
     int32_t delayTime = 0;
-    bool result = IdleAbility(saId, idleReason, delayTime);
+    bool result = IdleAbilityWithReason(saId, idleReason, delayTime);
     if (!reply.WriteBool(result)) {
         HILOGW(TAG, "ActiveAbilityInner Write result failed!");
         return ERR_NULL_OBJECT;
@@ -204,6 +464,143 @@ int32_t LocalAbilityManagerStub::IdleAbilityInner(MessageParcel& data, MessagePa
     return ERR_NONE;
 }
 
+int32_t LocalAbilityManagerStub::QueryProtocolInner(MessageParcel& data, MessageParcel& reply)
+{
+    if (!reply.WriteInt32(LOCAL_ABILITY_PROTOCOL_VERSION)) {
+        HILOGW(TAG, "QueryProtocolInner Write version failed!");
+        return ERR_NULL_OBJECT;
+    }
+    return ERR_NONE;
+}
+
+int32_t LocalAbilityManagerStub::ReadBinaryRequest(MessageParcel& data, int32_t& saId,
+    SystemAbilityOnDemandReason& reason)
+{
+    if (!data.ReadInt32(saId)) {
+        return ERR_NULL_OBJECT;
+    }
+    if (!CheckInputSysAbilityId(saId)) {
+        HILOGW(TAG, "check SA:%{public}d id failed!", saId);
+        return ERR_NULL_OBJECT;
+    }
+    if (!SystemAbilityOnDemandReason::Unmarshalling(data, reason)) {
+        HILOGW(TAG, "read reason of SA:%{public}d failed!", saId);
+        return ERR_NULL_OBJECT;
+    }
+    return ERR_NONE;
+}
+
+int32_t LocalAbilityManagerStub::StartAbilityBinaryInner(MessageParcel& data, MessageParcel& reply)
+{
+    int64_t begin = GetTickCount();
+    int32_t saId = -1;
+    SystemAbilityOnDemandReason startReason;
+    int32_t ret = ReadBinaryRequest(data, saId, startReason);
+    if (ret != ERR_NONE) {
+        return ret;
+    }
+    bool result = StartAbilityWithReason(saId, std::move(startReason));
+    LOGI("StartSaBinInner %{public}s to start SA:%{public}d,spend:%{public}" PRId64 "ms",
+        result ? "suc" : "fail", saId, (GetTickCount() - begin));
+    return ERR_NONE;
+}
+
+int32_t LocalAbilityManagerStub::StopAbilityBinaryInner(MessageParcel& data, MessageParcel& reply)
+{
+    int64_t begin = GetTickCount();
+    int32_t saId = -1;
+    SystemAbilityOnDemandReason stopReason;
+    int32_t ret = ReadBinaryRequest(data, saId, stopReason);
+    if (ret != ERR_NONE) {
+        return ret;
+    }
+    bool result = StopAbilityWithReason(saId, std::move(stopReason));
+    LOGI("StopSaBinInner %{public}s to stop SA:%{public}d,spend:%{public}" PRId64 "ms",
+        result ? "suc" : "fail", saId, (GetTickCount() - begin));
+    return ERR_NONE;
+}
+
+int32_t LocalAbilityManagerStub::ActiveAbilityBinaryInner(MessageParcel& data, MessageParcel& reply)
+{
+    int64_t begin = GetTickCount();
+    int32_t saId = -1;
+    SystemAbilityOnDemandReason activeReason;
+    int32_t ret = ReadBinaryRequest(data, saId, activeReason);
+    if (ret != ERR_NONE) {
+        return ret;
+    }
+    bool result = ActiveAbilityWithReason(saId, activeReason);
+    if (!reply.WriteBool(result)) {
+        HILOGW(TAG, "ActiveAbilityBinaryInner Write result failed!");
+        return ERR_NULL_OBJECT;
+    }
+    LOGI("ActiveSaBinInner %{public}s to Active SA:%{public}d,spend:%{public}" PRId64 "ms",
+        result ? "suc" : "fail", saId, (GetTickCount() - begin));
+    return ERR_NONE;
+}
+
+int32_t LocalAbilityManagerStub::IdleAbilityBinaryInner(MessageParcel& data, MessageParcel& reply)
+{
+    int64_t begin = GetTickCount();
+    int32_t saId = -1;
+    SystemAbilityOnDemandReason idleReason;
+    int32_t ret = ReadBinaryRequest(data, saId, idleReason);
+    if (ret != ERR_NONE) {
+        return ret;
+    }
+    int32_t delayTime = 0;
+    bool result = IdleAbilityWithReason(saId, idleReason, delayTime);
+    if (!reply.WriteBool(result)) {
+        HILOGW(TAG, "IdleAbilityBinaryInner Write result failed!");
+        return ERR_NULL_OBJECT;
+    }
+    if (!reply.WriteInt32(delayTime)) {
+        HILOGW(TAG, "IdleAbilityBinaryInner Write delayTime failed!");
+        return ERR_NULL_OBJECT;
+    }
+    LOGI("IdleSaBinInner %{public}s to Idle SA:%{public}d,delayTime:%{public}d,spend:%{public}" PRId64 "ms",
+        result ? "suc" : "fail", saId, delayTime, (GetTickCount() - begin));
+    return ERR_NONE;
+}
+
+int32_t LocalAbilityManagerStub::BatchLifecycleInner(MessageParcel& data, MessageParcel& reply)
+{
+    int64_t begin = GetTickCount();
+    int32_t num = 0;
+    if (!data.ReadInt32(num) || num <= 0 || num > MAX_LIFECYCLE_BATCH_NUM) {
+        HILOGW(TAG, "BatchLifecycleInner invalid num:%{public}d", num);
+        return ERR_NULL_OBJECT;
+    }
+    // the whole batch is read before any entry runs, a malformed entry rejects all of them
+    std::vector<SaLifecycleCommand> commands(num);
+    for (auto& command : commands) {
+        int32_t op = -1;
+        if (!data.ReadInt32(command.saId) || !CheckInputSysAbilityId(command.saId) || !data.ReadInt32(op) ||
+            op < static_cast<int32_t>(SaLifecycleOp::START) || op > static_cast<int32_t>(SaLifecycleOp::IDLE)) {
+            HILOGW(TAG, "BatchLifecycleInner invalid SA:%{public}d or op:%{public}d", command.saId, op);
+            return ERR_NULL_OBJECT;
+        }
+        command.op = static_cast<SaLifecycleOp>(op);
+        if (!SystemAbilityOnDemandReason::Unmarshalling(data, command.reason)) {
+            HILOGW(TAG, "BatchLifecycleInner read reason of SA:%{public}d failed!", command.saId);
+            return ERR_NULL_OBJECT;
+        }
+    }
+    BatchLifecycle(commands);
+    if (!reply.WriteInt32(num)) {
+        HILOGW(TAG, "BatchLifecycleInner Write num failed!");
+        return ERR_NULL_OBJECT;
+    }
+    for (const auto& command : commands) {
+        if (!reply.WriteBool(command.result) || !reply.WriteInt32(command.delayTime)) {
+            HILOGW(TAG, "BatchLifecycleInner Write result of SA:%{public}d failed!", command.saId);
+            return ERR_NULL_OBJECT;
+        }
+    }
+    LOGI("BatchSaInner num:%{public}d,spend:%{public}" PRId64 "ms", num, (GetTickCount() - begin));
+    return ERR_NONE;
+}
+
 int32_t LocalAbilityManagerStub::SendStrategyToSAInner(MessageParcel& data, MessageParcel& reply)
 {
     int32_t type = -1;
@@ -284,6 +681,91 @@ int32_t LocalAbilityManagerStub::FfrtStatCmdProcInner(MessageParcel& data, Messa
     return ERR_NONE;
 }
 
+bool LocalAbilityManagerStub::ReadStatCmd(MessageParcel& data, int32_t& fd, int32_t& cmd)
+{
+    fd = data.ReadFileDescriptor();
+    if (fd < 0) {
+        return false;
+    }
+    if (!data.ReadInt32(cmd)) {
+        ::close(fd);
+        return false;
+    }
+    return true;
+}
+
+int32_t LocalAbilityManagerStub::ListenerStatCmdProcInner(MessageParcel& data, MessageParcel& reply)
+{
+    int32_t fd = -1;
+    int32_t cmd = -1;
+    if (!ReadStatCmd(data, fd, cmd)) {
+        return ERR_NULL_OBJECT;
+    }
+    bool result = ListenerStatCmdProc(fd, cmd);
+    ::close(fd);
+    if (!reply.WriteBool(result)) {
+        HILOGW(TAG, "ListenerStatCmdProc Write result failed!");
+        return ERR_NULL_OBJECT;
+    }
+    HILOGD(TAG, "ListenerStatCmdProc called %{public}s", result ? "success" : "failed");
+    return ERR_NONE;
+}
+
+bool LocalAbilityManagerStub::ListenerStatCmdProc(int32_t fd, int32_t cmd)
+{
+    (void)fd;
+    (void)cmd;
+    return false;
+}
+
+int32_t LocalAbilityManagerStub::LifecycleMetricsCmdProcInner(MessageParcel& data, MessageParcel& reply)
+{
+    int32_t fd = -1;
+    int32_t cmd = -1;
+    if (!ReadStatCmd(data, fd, cmd)) {
+        return ERR_NULL_OBJECT;
+    }
+    bool result = LifecycleMetricsCmdProc(fd, cmd);
+    ::close(fd);
+    if (!reply.WriteBool(result)) {
+        HILOGW(TAG, "LifecycleMetricsCmdProc Write result failed!");
+        return ERR_NULL_OBJECT;
+    }
+    HILOGD(TAG, "LifecycleMetricsCmdProc called %{public}s", result ? "success" : "failed");
+    return ERR_NONE;
+}
+
+bool LocalAbilityManagerStub::LifecycleMetricsCmdProc(int32_t fd, int32_t cmd)
+{
+    (void)fd;
+    (void)cmd;
+    return false;
+}
+
+int32_t LocalAbilityManagerStub::SafwkTaskStatCmdProcInner(MessageParcel& data, MessageParcel& reply)
+{
+    int32_t fd = -1;
+    int32_t cmd = -1;
+    if (!ReadStatCmd(data, fd, cmd)) {
+        return ERR_NULL_OBJECT;
+    }
+    bool result = SafwkTaskStatCmdProc(fd, cmd);
+    ::close(fd);
+    if (!reply.WriteBool(result)) {
+        HILOGW(TAG, "SafwkTaskStatCmdProc Write result failed!");
+        return ERR_NULL_OBJECT;
+    }
+    HILOGD(TAG, "SafwkTaskStatCmdProc called %{public}s", result ? "success" : "failed");
+    return ERR_NONE;
+}
+
+bool LocalAbilityManagerStub::SafwkTaskStatCmdProc(int32_t fd, int32_t cmd)
+{
+    (void)fd;
+    (void)cmd;
+    return false;
+}
+
 int32_t LocalAbilityManagerStub::FfrtDumperProcInner(MessageParcel& data, MessageParcel& reply)
 {
     std::string ffrtDumperInfo;
@@ -328,11 +810,104 @@ int32_t LocalAbilityManagerStub::SystemAbilityExtProcInner(MessageParcel& data,
     return ERR_NONE;
 }
 
+int32_t LocalAbilityManagerStub::SystemAbilityExtAsyncInner(MessageParcel& data, MessageParcel& reply)
+{
+    int32_t saId = -1;
+    if (!data.ReadInt32(saId)) {
+        return INVALID_DATA;
+    }
+    std::string extension = data.ReadString();
+    sptr<IRemoteObject> callback = data.ReadRemoteObject();
+    if (callback == nullptr) {
+        HILOGW(TAG, "SA:%{public}d read callback failed!", saId);
+        return INVALID_DATA;
+    }
+    auto extReply = std::make_shared<SystemAbilityExtensionReply>(saId, extension, callback);
+    if (!CheckInputSysAbilityId(saId) || extension.empty()) {
+        HILOGW(TAG, "SA:%{public}d invalid ext request!", saId);
+        extReply->Complete(INVALID_DATA);
+        return INVALID_DATA;
+    }
+    int32_t result = SystemAbilityExtProcAsync(extension, saId, data, extReply);
+    if (result == SA_EXTENSION_PENDING) {
+        HILOGD(TAG, "SA:%{public}d ext:%{public}s pending", saId, extension.c_str());
+        return ERR_NONE;
+    }
+    extReply->Complete(result);
+    return ERR_NONE;
+}
+
+int32_t LocalAbilityManagerStub::SystemAbilityExtProcAsync(const std::string& extension, int32_t said,
+    MessageParcel& data, const std::shared_ptr<SystemAbilityExtensionReply>& reply)
+{
+    SystemAbilityExtensionPara callback;
+    callback.data_ = &data;
+    callback.reply_ = &reply->GetReply();
+    return SystemAbilityExtProc(extension, said, &callback, true);
+}
+
 bool LocalAbilityManagerStub::CheckInputSysAbilityId(int32_t systemAbilityId)
 {
     return (systemAbilityId >= FIRST_SYS_ABILITY_ID) && (systemAbilityId <= LAST_SYS_ABILITY_ID);
 }
 
+bool LocalAbilityManagerStub::ParseOnDemandReason(const std::string& eventStr, SystemAbilityOnDemandReason& reason)
+{
+    SystemAbilityOnDemandReason parsedReason;
+    OnDemandReasonSaxHandler handler(parsedReason);
+    if (!nlohmann::json::sax_parse(eventStr, &handler)) {
+        return false;
+    }
+    reason = std::move(parsedReason);
+    return true;
+}
+
+bool LocalAbilityManagerStub::StartAbilityWithReason(int32_t systemAbilityId,
+    SystemAbilityOnDemandReason&& startReason)
+{
+    return StartAbility(systemAbilityId, OnDemandReasonToJson(startReason).dump());
+}
+
+bool LocalAbilityManagerStub::StopAbilityWithReason(int32_t systemAbilityId,
+    SystemAbilityOnDemandReason&& stopReason)
+{
+    return StopAbility(systemAbilityId, OnDemandReasonToJson(stopReason).dump());
+}
+
+void LocalAbilityManagerStub::BatchLifecycle(std::vector<SaLifecycleCommand>& commands)
+{
+    for (auto& command : commands) {
+        switch (command.op) {
+            case SaLifecycleOp::START:
+                command.result = StartAbilityWithReason(command.saId, std::move(command.reason));
+                break;
+            case SaLifecycleOp::STOP:
+                command.result = StopAbilityWithReason(command.saId, std::move(command.reason));
+                break;
+            case SaLifecycleOp::ACTIVE:
+                command.result = ActiveAbilityWithReason(command.saId, command.reason);
+                break;
+            case SaLifecycleOp::IDLE:
+                command.result = IdleAbilityWithReason(command.saId, command.reason, command.delayTime);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+bool LocalAbilityManagerStub::ActiveAbilityWithReason(int32_t systemAbilityId,
+    SystemAbilityOnDemandReason& activeReason)
+{
+    return ActiveAbility(systemAbilityId, OnDemandReasonToJson(activeReason));
+}
+
+bool LocalAbilityManagerStub::IdleAbilityWithReason(int32_t systemAbilityId,
+    SystemAbilityOnDemandReason& idleReason, int32_t& delayTime)
+{
+    return IdleAbility(systemAbilityId, OnDemandReasonToJson(idleReason), delayTime);
+}
+
 bool LocalAbilityManagerStub::EnforceInterceToken(MessageParcel& data)
 {
     std::u16string interfaceToken = data.ReadInterfaceToken();
@@ -32,10 +32,6 @@ using std::string;
 
 namespace {
 constexpr const char* PARAM_PREFIX_M = "-m";
-constexpr const char* EVENT_TYPE = "eventId";
-constexpr const char* EVENT_NAME = "name";
-constexpr const char* EVENT_VALUE = "value";
-constexpr const char* EVENT_EXTRA_DATA_ID = "extraDataId";
 #ifdef CONFIG_USE_JEMALLOC_DFX_INTF
 constexpr const char* MALLOPT_CONFIG_SEPARATOR = ":";
 #endif
@@ -105,7 +101,7 @@ static void SetProcName(const string& filePath, const ProcessNameSetFunc& setPro
 }
 
 // check argv size with SAID_INDEX before using the function
-static int32_t ParseArgv(char *argv[], nlohmann::json& eventMap, int eventIndex)
+static int32_t ParseArgv(char *argv[], SystemAbilityOnDemandReason& eventReason, int eventIndex)
 {
     string eventStr(argv[eventIndex]);
     HILOGI(TAG, "ParseArgv extraArgv eventStr:%{public}s!", eventStr.c_str());
@@ -129,11 +125,10 @@ static int32_t ParseArgv(char *argv[], nlohmann::json& eventMap, int eventIndex)
         HILOGE(TAG, "eventVec[0] StrToInt said error");
         return DEFAULT_SAID;
     }
-    eventMap[EVENT_TYPE] = atoi(eventVec[ID_INDEX].c_str());
-    eventMap[EVENT_NAME] = eventVec[NAME_INDEX];
-    eventMap[EVENT_VALUE] = eventVec[VALUE_INDEX];
-    eventMap[EVENT_EXTRA_DATA_ID] = atoi(eventVec[EXTRA_DATA_ID_INDEX].c_str());
-    HILOGD(TAG, "ParseArgv extraDataId :%{public}d!", atoi(eventVec[EXTRA_DATA_ID_INDEX].c_str()));
+    int extraDataId = atoi(eventVec[EXTRA_DATA_ID_INDEX].c_str());
+    eventReason = SystemAbilityOnDemandReason(static_cast<OnDemandReasonId>(atoi(eventVec[ID_INDEX].c_str())),
+        eventVec[NAME_INDEX], eventVec[VALUE_INDEX], extraDataId);
+    HILOGD(TAG, "ParseArgv extraDataId :%{public}d!", extraDataId);
     return saId;
 }
 
@@ -231,19 +226,19 @@ int main(int argc, char *argv[])
     // when this process starts.
     int32_t saId = DEFAULT_SAID;
     if (argc > ondemandLoad) {
-        nlohmann::json eventMap;
+        SystemAbilityOnDemandReason eventReason;
         if (eventIndex >= argc) {
             ReportSaMainExit("sa services path config error");
             HILOGE(TAG, "sa services path config error!");
             return 0;
         }
-        saId = ParseArgv(argv, eventMap, eventIndex);
+        saId = ParseArgv(argv, eventReason, eventIndex);
         if (!CheckSaId(saId)) {
             ReportSaMainExit("saId is invalid");
             HILOGE(TAG, "saId is invalid!");
             return 0;
         }
-        LocalAbilityManager::GetInstance().SetStartReason(saId, eventMap);
+        LocalAbilityManager::GetInstance().SetStartReason(saId, std::move(eventReason));
     }
     
     DoStartSAProcess(argc, argv, saId);
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sa_metrics.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "safwk_log.h"
+
+namespace OHOS {
+namespace {
+constexpr const char* PHASE_NAMES[] = {
+    "OnStart", "OnStop", "OnIdle", "OnActive", "Publish", "RemoveSystemAbility", "LoadSaLib",
+};
+static_assert(std::size(PHASE_NAMES) == static_cast<size_t>(SaPhase::PHASE_NUM), "a phase has no name");
+}
+
+IMPLEMENT_SINGLE_INSTANCE(SaMetrics);
+
+SaMetrics::ScopedTimer::~ScopedTimer()
+{
+    int64_t duration = GetMicroTickCount() - begin_;
+    SaMetrics::GetInstance().Record(saId_, phase_, static_cast<uint64_t>(std::max<int64_t>(duration, 0)));
+}
+
+SaMetrics::PhaseHistograms* SaMetrics::GetHistograms(int32_t saId)
+{
+    if (saId <= 0) {
+        return nullptr;
+    }
+    uint32_t start = static_cast<uint32_t>(saId) % MAX_SA_NUM;
+    for (uint32_t probe = 0; probe < MAX_SA_NUM; ++probe) {
+        uint32_t slot = (start + probe) % MAX_SA_NUM;
+        int32_t current = saIds_[slot].load(std::memory_order_acquire);
+        // if another SA takes the free slot first, the failed exchange loads its id into current
+        if (current == 0 && saIds_[slot].compare_exchange_strong(current, saId, std::memory_order_acq_rel)) {
+            current = saId;
+        }
+        if (current != saId) {
+            continue;
+        }
+        PhaseHistograms* histograms = histograms_[slot].load(std::memory_order_acquire);
+        if (histograms != nullptr) {
+            return histograms;
+        }
+        auto created = new PhaseHistograms();
+        if (histograms_[slot].compare_exchange_strong(histograms, created, std::memory_order_acq_rel)) {
+            return created;
+        }
+        delete created;
+        return histograms;
+    }
+    if (!fullReported_.exchange(true)) {
+        HILOGW(TAG, "SA metrics full, SA:%{public}d not recorded", saId);
+    }
+    return nullptr;
+}
+
+void SaMetrics::Record(int32_t saId, SaPhase phase, uint64_t durationUs)
+{
+    if (phase >= SaPhase::PHASE_NUM) {
+        return;
+    }
+    PhaseHistograms* histograms = GetHistograms(saId);
+    if (histograms != nullptr) {
+        (*histograms)[static_cast<size_t>(phase)].Record(durationUs);
+    }
+}
+
+void SaMetrics::Dump(std::string& result)
+{
+    std::vector<std::pair<int32_t, PhaseHistograms*>> entries;
+    for (uint32_t slot = 0; slot < MAX_SA_NUM; ++slot) {
+        PhaseHistograms* histograms = histograms_[slot].load(std::memory_order_acquire);
+        if (histograms != nullptr) {
+            entries.emplace_back(saIds_[slot].load(std::memory_order_relaxed), histograms);
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+    result.append("SA lifecycle metrics(us)\n");
+    for (const auto& [saId, histograms] : entries) {
+        for (size_t phase = 0; phase < histograms->size(); ++phase) {
+            auto summary = (*histograms)[phase].GetSummary();
+            if (summary.count == 0) {
+                continue;
+            }
+            result.append("SA:" + std::to_string(saId) + " " + PHASE_NAMES[phase] + " ");
+            LatencyHistogram::FormatSummary(summary, result);
+            result.append("\n");
+        }
+    }
+}
+
+void SaMetrics::Reset()
+{
+    for (auto& slot : histograms_) {
+        PhaseHistograms* histograms = slot.load(std::memory_order_acquire);
+        if (histograms == nullptr) {
+            continue;
+        }
+        for (auto& histogram : *histograms) {
+            histogram.Reset();
+        }
+    }
+}
+} // namespace OHOS
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "serial_task_pool.h"
+
+#include <algorithm>
+#include <pthread.h>
+
+#include "datetime_ex.h"
+#include "ffrt_task_stats.h"
+#include "safwk_log.h"
+
+namespace OHOS {
+SerialTaskPool::SerialTaskPool(const std::string& name, uint32_t threadNum)
+    : name_(name), threadNum_(std::max<uint32_t>(threadNum, 1))
+{
+}
+
+SerialTaskPool::~SerialTaskPool()
+{
+    {
+        std::lock_guard<std::mutex> autoLock(mutex_);
+        stopped_ = true;
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+bool SerialTaskPool::PostTask(int32_t queueId, std::function<void()> func, const std::string& name,
+    uint64_t delayTime, const std::string& statName)
+{
+    uint32_t statId = FfrtTaskStats::GetInstance().GetNameId(statName.empty() ? name : statName);
+    std::lock_guard<std::mutex> autoLock(mutex_);
+    if (stopped_) {
+        LOGE("SerialTaskPool %{public}s stopped", name_.c_str());
+        return false;
+    }
+    if (delayTime == 0) {
+        ScheduleLocked(queueId, Task { name, statId, std::move(func) });
+        return true;
+    }
+    Clock::time_point dueTime = Clock::now() + std::chrono::milliseconds(delayTime);
+    delayedTasks_.emplace(dueTime, DelayedTask { queueId, Task { name, statId, std::move(func) } });
+    // an idle thread recomputes its wake up time, as this task may be due before the ones it waits for
+    WakeThreadLocked();
+    return true;
+}
+
+void SerialTaskPool::RemoveTask(int32_t queueId, const std::string& name)
+{
+    std::lock_guard<std::mutex> autoLock(mutex_);
+    auto iter = queues_.find(queueId);
+    if (iter != queues_.end()) {
+        auto& tasks = iter->second;
+        tasks.erase(std::remove_if(tasks.begin(), tasks.end(),
+            [&name](const Task& task) { return task.name == name; }), tasks.end());
+    }
+    for (auto delayedIter = delayedTasks_.begin(); delayedIter != delayedTasks_.end();) {
+        if (delayedIter->second.queueId == queueId && delayedIter->second.task.name == name) {
+            delayedIter = delayedTasks_.erase(delayedIter);
+        } else {
+            ++delayedIter;
+        }
+    }
+}
+
+void SerialTaskPool::RemoveQueue(int32_t queueId)
+{
+    std::lock_guard<std::mutex> autoLock(mutex_);
+    // the queue itself is dropped by the thread that finds it empty
+    auto iter = queues_.find(queueId);
+    if (iter != queues_.end()) {
+        iter->second.clear();
+    }
+    for (auto delayedIter = delayedTasks_.begin(); delayedIter != delayedTasks_.end();) {
+        if (delayedIter->second.queueId == queueId) {
+            delayedIter = delayedTasks_.erase(delayedIter);
+        } else {
+            ++delayedIter;
+        }
+    }
+}
+
+void SerialTaskPool::ScheduleLocked(int32_t queueId, Task&& task)
+{
+    auto [iter, isNew] = queues_.try_emplace(queueId);
+    iter->second.emplace_back(std::move(task));
+    if (isNew) {
+        readyQueues_.push_back(queueId);
+        WakeThreadLocked();
+    }
+}
+
+void SerialTaskPool::MoveDueTasksLocked(Clock::time_point now)
+{
+    while (!delayedTasks_.empty() && delayedTasks_.begin()->first <= now) {
+        auto node = delayedTasks_.extract(delayedTasks_.begin());
+        ScheduleLocked(node.mapped().queueId, std::move(node.mapped().task));
+    }
+}
+
+void SerialTaskPool::WakeThreadLocked()
+{
+    // a notified thread is claimed at once, so later posts until it wakes up do not count on it as idle
+    if (idleThreadNum_ > 0) {
+        --idleThreadNum_;
+        ++wakeNum_;
+        cv_.notify_one();
+        return;
+    }
+    if (threads_.size() < threadNum_) {
+        threads_.emplace_back([this] { WorkLoop(); });
+    }
+}
+
+void SerialTaskPool::WorkLoop()
+{
+    pthread_setname_np(pthread_self(), name_.c_str());
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopped_) {
+        MoveDueTasksLocked(Clock::now());
+        if (readyQueues_.empty()) {
+            ++idleThreadNum_;
+            if (delayedTasks_.empty()) {
+                cv_.wait(lock);
+            } else {
+                cv_.wait_until(lock, delayedTasks_.begin()->first);
+            }
+            // a thread waking on its own may take the claim of the notified one, which then counts itself out
+            if (wakeNum_ > 0) {
+                --wakeNum_;
+            } else {
+                --idleThreadNum_;
+            }
+            continue;
+        }
+        int32_t queueId = readyQueues_.front();
+        readyQueues_.pop_front();
+        auto iter = queues_.find(queueId);
+        if (iter->second.empty()) {
+            queues_.erase(iter);
+            continue;
+        }
+        Task task = std::move(iter->second.front());
+        iter->second.pop_front();
+        lock.unlock();
+        uint64_t startTime = static_cast<uint64_t>(GetMicroTickCount());
+        task.func();
+        FfrtTaskStats::GetInstance().Record(task.statId, startTime, static_cast<uint64_t>(GetMicroTickCount()));
+        lock.lock();
+        // only this thread erases the queue while it runs, so iter is still valid
+        if (iter->second.empty()) {
+            queues_.erase(iter);
+        } else {
+            readyQueues_.push_back(queueId);
+        }
+    }
+}
+} // namespace OHOS
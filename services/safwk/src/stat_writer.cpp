@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stat_writer.h"
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+namespace OHOS {
+StatWriter::~StatWriter()
+{
+    Flush();
+}
+
+StatWriter& StatWriter::Append(std::string_view str)
+{
+    if (size_ + str.size() > BUFFER_SIZE) {
+        Flush();
+        if (str.size() >= BUFFER_SIZE) {
+            WriteOut(str.data(), str.size());
+            return *this;
+        }
+    }
+    std::memcpy(buffer_.data() + size_, str.data(), str.size());
+    size_ += str.size();
+    return *this;
+}
+
+StatWriter& StatWriter::Append(char ch)
+{
+    if (size_ == BUFFER_SIZE) {
+        Flush();
+    }
+    buffer_[size_++] = ch;
+    return *this;
+}
+
+StatWriter& StatWriter::AppendCsvField(std::string_view str)
+{
+    if (str.find_first_of(",\"\r\n") == std::string_view::npos) {
+        return Append(str);
+    }
+    Append('"');
+    size_t start = 0;
+    for (size_t quote = str.find('"'); quote != std::string_view::npos; quote = str.find('"', start)) {
+        Append(str.substr(start, quote + 1 - start));
+        Append('"');
+        start = quote + 1;
+    }
+    Append(str.substr(start));
+    return Append('"');
+}
+
+bool StatWriter::Flush()
+{
+    if (size_ > 0) {
+        WriteOut(buffer_.data(), size_);
+        size_ = 0;
+    }
+    return !failed_;
+}
+
+void StatWriter::WriteOut(const char* data, size_t len)
+{
+    if (failed_) {
+        return;
+    }
+    if (result_ != nullptr) {
+        result_->append(data, len);
+        return;
+    }
+    while (len > 0) {
+        ssize_t written = write(fd_, data, len);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            failed_ = true;
+            return;
+        }
+        data += written;
+        len -= static_cast<size_t>(written);
+    }
+}
+} // namespace OHOS
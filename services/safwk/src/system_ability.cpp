@@ -25,6 +25,7 @@
 #include "iservice_registry.h"
 #include "local_ability_manager.h"
 #include "nlohmann/json.hpp"
+#include "sa_metrics.h"
 #include "safwk_log.h"
 #include "string_ex.h"
 #include "samgr_xcollie.h"
@@ -65,6 +66,12 @@ bool SystemAbility::AddSystemAbilityListener(int32_t systemAbilityId)
     return LocalAbilityManager::GetInstance().AddSystemAbilityListener(systemAbilityId, saId_);
 }
 
+bool SystemAbility::AddSystemAbilityListeners(const std::vector<int32_t>& systemAbilityIds)
+{
+    HILOGD(TAG, "SA num:%{public}zu, listenerSA:%{public}d", systemAbilityIds.size(), saId_);
+    return LocalAbilityManager::GetInstance().AddSystemAbilityListeners(systemAbilityIds, saId_);
+}
+
 bool SystemAbility::RemoveSystemAbilityListener(int32_t systemAbilityId)
 {
     HILOGD(TAG, "SA:%{public}d, listenerSA:%{public}d", systemAbilityId, saId_);
@@ -89,7 +96,11 @@ bool SystemAbility::Publish(sptr<IRemoteObject> systemAbility)
 
     ISystemAbilityManager::SAExtraProp saExtra(GetDistributed(), GetDumpLevel(), capability_, permission_);
     std::lock_guard<std::recursive_mutex> autoLock(abilityLock);
-    int32_t result = samgrProxy->AddSystemAbility(saId_, publishObj_, saExtra);
+    int32_t result = ERR_OK;
+    {
+        SaMetrics::ScopedTimer timer(saId_, SaPhase::PUBLISH);
+        result = samgrProxy->AddSystemAbility(saId_, publishObj_, saExtra);
+    }
     KHILOGI(TAG, "SA:%{public}d result:%{public}d,spend:%{public}" PRId64 "ms",
         saId_, result, (GetTickCount() - begin));
     if (result == ERR_OK) {
@@ -142,14 +153,18 @@ void SystemAbility::StopAbility(int32_t systemAbilityId)
         return;
     }
     int64_t begin = GetTickCount();
-    int32_t ret = samgrProxy->RemoveSystemAbility(systemAbilityId);
+    int32_t ret = ERR_OK;
+    {
+        SaMetrics::ScopedTimer timer(systemAbilityId, SaPhase::REMOVE);
+        ret = samgrProxy->RemoveSystemAbility(systemAbilityId);
+    }
     KHILOGI(TAG, "%{public}s to rm SA:%{public}d, spend:%{public}" PRId64 " ms",
         (ret == ERR_OK) ? "success" : "failed", systemAbilityId, (GetTickCount() - begin));
 }
 
 void SystemAbility::GetOnDemandReasonExtraData(SystemAbilityOnDemandReason& onDemandStartReason)
 {
-    if (!onDemandStartReason.HasExtraData()) {
+    if (!onDemandStartReason.HasExtraData() || onDemandStartReason.IsExtraDataLoaded()) {
         return;
     }
     sptr<ISystemAbilityManager> samgrProxy = SystemAbilityManagerClient::GetInstance().GetSystemAbilityManager();
@@ -175,6 +190,16 @@ void SystemAbility::GetOnDemandReasonExtraData(SystemAbilityOnDemandReason& onDe
     delete extraData;
 }
 
+std::vector<SystemAbilityOnDemandReason> SystemAbility::GetMergedStartReasons()
+{
+    std::vector<SystemAbilityOnDemandReason> startReasons =
+        LocalAbilityManager::GetInstance().GetMergedStartReasons(saId_);
+    for (auto& startReason : startReasons) {
+        GetOnDemandReasonExtraData(startReason);
+    }
+    return startReasons;
+}
+
 void SystemAbility::Start()
 {
     // Ensure that the lifecycle is sequentially called by SAMGR
@@ -187,15 +212,14 @@ void SystemAbility::Start()
             return;
         }
     }
-    nlohmann::json startReason = LocalAbilityManager::GetInstance().GetStartReason(saId_);
-    SystemAbilityOnDemandReason onDemandStartReason =
-        LocalAbilityManager::GetInstance().JsonToOnDemandReason(startReason);
+    SystemAbilityOnDemandReason onDemandStartReason = LocalAbilityManager::GetInstance().GetStartReason(saId_);
     GetOnDemandReasonExtraData(onDemandStartReason);
     LOGI("Start-SA:%{public}d", saId_);
     int64_t begin = GetTickCount();
     {
         std::string onStartTag = ToString(saId_) + "_OnStart";
         HitraceScopedEx samgrHitrace(HITRACE_LEVEL_INFO, HITRACE_TAG_SAMGR, onStartTag.c_str());
+        SaMetrics::ScopedTimer timer(saId_, SaPhase::ON_START);
         OnStart(onDemandStartReason);
     }
     int64_t duration = GetTickCount() - begin;
@@ -222,6 +246,7 @@ void SystemAbility::Idle(SystemAbilityOnDemandReason& idleReason,
     int64_t begin = GetTickCount();
     {
         SamgrXCollie samgrXCollie("safwk--onIdle_" + ToString(saId_));
+        SaMetrics::ScopedTimer timer(saId_, SaPhase::ON_IDLE);
         delayTime = OnIdle(idleReason);
     }
     LOGI("OnIdle-SA:%{public}d end,spend:%{public}" PRId64 "ms",
@@ -246,6 +271,7 @@ void SystemAbility::Active(SystemAbilityOnDemandReason& activeReason)
     int64_t begin = GetTickCount();
     {
         SamgrXCollie samgrXCollie("safwk--onActive_" + ToString(saId_));
+        SaMetrics::ScopedTimer timer(saId_, SaPhase::ON_ACTIVE);
         OnActive(activeReason);
     }
     LOGI("OnActive-SA:%{public}d end,spend:%{public}" PRId64 "ms",
@@ -264,15 +290,14 @@ void SystemAbility::Stop()
             return;
         }
     }
-    nlohmann::json stopReason = LocalAbilityManager::GetInstance().GetStopReason(saId_);
-    SystemAbilityOnDemandReason onDemandStopReason =
-        LocalAbilityManager::GetInstance().JsonToOnDemandReason(stopReason);
+    SystemAbilityOnDemandReason onDemandStopReason = LocalAbilityManager::GetInstance().GetStopReason(saId_);
     GetOnDemandReasonExtraData(onDemandStopReason);
 
     LOGI("Stop-SA:%{public}d", saId_);
     int64_t begin = GetTickCount();
     {
         SamgrXCollie samgrXCollie("safwk--onStop_" + ToString(saId_));
+        SaMetrics::ScopedTimer timer(saId_, SaPhase::ON_STOP);
         OnStop(onDemandStopReason);
     }
     int64_t duration = GetTickCount() - begin;
@@ -289,7 +314,11 @@ void SystemAbility::Stop()
         return;
     }
     begin = GetTickCount();
-    int32_t ret = samgrProxy->RemoveSystemAbility(saId_);
+    int32_t ret = ERR_OK;
+    {
+        SaMetrics::ScopedTimer timer(saId_, SaPhase::REMOVE);
+        ret = samgrProxy->RemoveSystemAbility(saId_);
+    }
     KHILOGI(TAG, "%{public}s to rm SA:%{public}d,spend:%{public}" PRId64 "ms",
         (ret == ERR_OK) ? "suc" : "fail", saId_, (GetTickCount() - begin));
 }
@@ -471,6 +500,12 @@ int32_t SystemAbility::OnExtension(const std::string& extension, MessageParcel&
     return 0;
 }
 
+int32_t SystemAbility::OnExtensionAsync(const std::string& extension, MessageParcel& data,
+    const std::shared_ptr<SystemAbilityExtensionReply>& reply)
+{
+    return OnExtension(extension, data, reply->GetReply());
+}
+
 sptr<IRemoteObject> SystemAbility::GetAbilityRemoteObject()
 {
     return publishObj_;
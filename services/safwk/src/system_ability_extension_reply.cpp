@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "system_ability_extension_reply.h"
+
+#include "ipc_types.h"
+#include "message_option.h"
+#include "safwk_log.h"
+
+namespace OHOS {
+SystemAbilityExtensionReply::SystemAbilityExtensionReply(int32_t saId, const std::string& extension,
+    const sptr<IRemoteObject>& callback) : saId_(saId), extension_(extension), callback_(callback)
+{
+}
+
+SystemAbilityExtensionReply::~SystemAbilityExtensionReply()
+{
+    if (!IsCompleted()) {
+        HILOGW(TAG, "SA:%{public}d ext:%{public}s reply dropped", saId_, extension_.c_str());
+        Complete(ERR_INVALID_STATE);
+    }
+}
+
+MessageParcel& SystemAbilityExtensionReply::GetReply()
+{
+    return reply_;
+}
+
+bool SystemAbilityExtensionReply::IsCompleted() const
+{
+    return completed_.load(std::memory_order_acquire);
+}
+
+bool SystemAbilityExtensionReply::Complete(int32_t result)
+{
+    if (completed_.exchange(true, std::memory_order_acq_rel)) {
+        HILOGW(TAG, "SA:%{public}d ext:%{public}s already completed", saId_, extension_.c_str());
+        return false;
+    }
+    if (callback_ == nullptr) {
+        HILOGE(TAG, "SA:%{public}d ext:%{public}s no callback", saId_, extension_.c_str());
+        return false;
+    }
+    MessageParcel data;
+    if (!data.WriteInt32(result) || !data.Append(reply_)) {
+        HILOGE(TAG, "SA:%{public}d ext:%{public}s write reply failed", saId_, extension_.c_str());
+        return false;
+    }
+    MessageParcel unused;
+    MessageOption option(MessageOption::TF_ASYNC);
+    int32_t ret = callback_->SendRequest(SA_EXTENSION_REPLY_CODE, data, unused, option);
+    if (ret != ERR_NONE) {
+        HILOGE(TAG, "SA:%{public}d ext:%{public}s send reply failed:%{public}d", saId_, extension_.c_str(), ret);
+        return false;
+    }
+    HILOGD(TAG, "SA:%{public}d ext:%{public}s completed:%{public}d", saId_, extension_.c_str(), result);
+    return true;
+}
+}
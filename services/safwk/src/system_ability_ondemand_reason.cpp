@@ -13,16 +13,43 @@
  * limitations under the License.
  */
 
+#include <limits>
+#include <mutex>
+
 #include "parse_util.h"
 #include "system_ability_ondemand_reason.h"
 
 namespace OHOS {
+namespace {
+constexpr int32_t MIN_REASON_PARCEL_VERSION = 1;
+constexpr int32_t INLINE_EXTRA_DATA_PARCEL_VERSION = 2;
+constexpr int32_t SIZED_REASON_PARCEL_VERSION = 2;
+constexpr size_t WANT_PAIR_LENGTHS = 2;
+}
+
+// Shared by copies of the same extra data. Unmarshalling keeps the json payload as read, it is decoded into
+// flat/lengths at most once, and the view and map over flat are built only when asked for.
+struct OnDemandReasonExtraData::WantState {
+    std::string json;
+    std::string flat;
+    std::vector<uint32_t> lengths;
+    std::once_flag viewOnce;
+    WantView view;
+    std::once_flag mapOnce;
+    std::map<std::string, std::string> want;
+};
+
 OnDemandReasonExtraData::OnDemandReasonExtraData(int32_t code, const std::string& data,
     const std::map<std::string, std::string>& want)
 {
     code_ = code;
     data_ = data;
-    want_ = want;
+    want_ = std::make_shared<WantState>();
+    for (const auto& [key, value] : want) {
+        want_->flat.append(key).append(value);
+        want_->lengths.push_back(static_cast<uint32_t>(key.size()));
+        want_->lengths.push_back(static_cast<uint32_t>(value.size()));
+    }
 }
 
 std::string OnDemandReasonExtraData::GetData() const
@@ -35,12 +62,57 @@ int32_t OnDemandReasonExtraData::GetCode() const
     return code_;
 }
 
+const OnDemandReasonExtraData::WantView& OnDemandReasonExtraData::GetWantView() const
+{
+    static const WantView emptyView;
+    if (want_ == nullptr) {
+        return emptyView;
+    }
+    WantState& state = *want_;
+    std::call_once(state.viewOnce, [&state]() {
+        if (!state.json.empty()) {
+            nlohmann::json payload = ParseUtil::StringToJsonObj(state.json);
+            for (nlohmann::json::iterator it = payload.begin(); it != payload.end(); ++it) {
+                if (!it.value().is_string()) {
+                    continue;
+                }
+                const std::string& value = it.value().get_ref<const std::string&>();
+                state.flat.append(it.key()).append(value);
+                state.lengths.push_back(static_cast<uint32_t>(it.key().size()));
+                state.lengths.push_back(static_cast<uint32_t>(value.size()));
+            }
+        }
+        std::string_view flat(state.flat);
+        size_t offset = 0;
+        state.view.reserve(state.lengths.size() / WANT_PAIR_LENGTHS);
+        for (size_t i = 0; i + 1 < state.lengths.size(); i += WANT_PAIR_LENGTHS) {
+            std::string_view key = flat.substr(offset, state.lengths[i]);
+            offset += key.size();
+            std::string_view value = flat.substr(offset, state.lengths[i + 1]);
+            offset += value.size();
+            state.view.emplace_back(key, value);
+        }
+    });
+    return state.view;
+}
+
 const std::map<std::string, std::string>& OnDemandReasonExtraData::GetWant() const
 {
-    return want_;
+    static const std::map<std::string, std::string> emptyWant;
+    if (want_ == nullptr) {
+        return emptyWant;
+    }
+    const WantView& view = GetWantView();
+    WantState& state = *want_;
+    std::call_once(state.mapOnce, [&state, &view]() {
+        for (const auto& [key, value] : view) {
+            state.want.emplace(key, value);
+        }
+    });
+    return state.want;
 }
 
-bool OnDemandReasonExtraData::Marshalling(Parcel& parcel) const
+bool OnDemandReasonExtraData::MarshallingCodeAndData(Parcel& parcel) const
 {
     if (!parcel.WriteInt32(code_)) {
         return false;
@@ -48,9 +120,31 @@ bool OnDemandReasonExtraData::Marshalling(Parcel& parcel) const
     if (!parcel.WriteString(data_)) {
         return false;
     }
+    return true;
+}
+
+bool OnDemandReasonExtraData::UnmarshallingCodeAndData(Parcel& parcel, int32_t& code, std::string& data)
+{
+    if (!parcel.ReadInt32(code)) {
+        return false;
+    }
+    if (!parcel.ReadString(data)) {
+        return false;
+    }
+    return true;
+}
+
+bool OnDemandReasonExtraData::Marshalling(Parcel& parcel) const
+{
+    if (!MarshallingCodeAndData(parcel)) {
+        return false;
+    }
+    if (want_ != nullptr && !want_->json.empty()) {
+        return parcel.WriteString(want_->json);
+    }
     nlohmann::json payload;
-    for (auto it = want_.begin(); it != want_.end(); ++it) {
-        payload[it->first] = it->second;
+    for (const auto& [key, value] : GetWantView()) {
+        payload[std::string(key)] = value;
     }
     if (!parcel.WriteString(payload.dump())) {
         return false;
@@ -61,22 +155,61 @@ bool OnDemandReasonExtraData::Marshalling(Parcel& parcel) const
 OnDemandReasonExtraData *OnDemandReasonExtraData::Unmarshalling(Parcel& parcel)
 {
     int32_t code = 0;
-    if (!parcel.ReadInt32(code)) {
+    std::string data;
+    if (!UnmarshallingCodeAndData(parcel, code, data)) {
         return nullptr;
     }
+    OnDemandReasonExtraData* extraData = new OnDemandReasonExtraData();
+    extraData->code_ = code;
+    extraData->data_ = std::move(data);
+    extraData->want_ = std::make_shared<WantState>();
+    extraData->want_->json = parcel.ReadString();
+    return extraData;
+}
+
+bool OnDemandReasonExtraData::MarshallingCompact(Parcel& parcel) const
+{
+    if (!MarshallingCodeAndData(parcel)) {
+        return false;
+    }
+    if (want_ == nullptr) {
+        return parcel.WriteString("") && parcel.WriteUInt32Vector({});
+    }
+    GetWantView();
+    if (!parcel.WriteString(want_->flat)) {
+        return false;
+    }
+    if (!parcel.WriteUInt32Vector(want_->lengths)) {
+        return false;
+    }
+    return true;
+}
+
+bool OnDemandReasonExtraData::UnmarshallingCompact(Parcel& parcel, OnDemandReasonExtraData& extraData)
+{
+    int32_t code = 0;
     std::string data;
-    if (!parcel.ReadString(data)) {
-        return nullptr;
+    if (!UnmarshallingCodeAndData(parcel, code, data)) {
+        return false;
     }
-    std::map<std::string, std::string> want;
-    nlohmann::json payload = ParseUtil::StringToJsonObj(parcel.ReadString());
-    for (nlohmann::json::iterator it = payload.begin(); it != payload.end(); ++it) {
-        if (it.value().is_string()) {
-            want[it.key()] = it.value();
-        }
+    auto state = std::make_shared<WantState>();
+    if (!parcel.ReadString(state->flat)) {
+        return false;
     }
-    OnDemandReasonExtraData* extraData = new OnDemandReasonExtraData(code, data, want);
-    return extraData;
+    if (!parcel.ReadUInt32Vector(&state->lengths) || state->lengths.size() % WANT_PAIR_LENGTHS != 0) {
+        return false;
+    }
+    uint64_t total = 0;
+    for (uint32_t length : state->lengths) {
+        total += length;
+    }
+    if (total != state->flat.size()) {
+        return false;
+    }
+    extraData.code_ = code;
+    extraData.data_ = std::move(data);
+    extraData.want_ = std::move(state);
+    return true;
 }
 
 SystemAbilityOnDemandReason::SystemAbilityOnDemandReason(OnDemandReasonId reasonId, const std::string& reasonName,
@@ -136,10 +269,113 @@ bool SystemAbilityOnDemandReason::HasExtraData() const
 void SystemAbilityOnDemandReason::SetExtraData(OnDemandReasonExtraData& extraData)
 {
     extraData_ = extraData;
+    extraDataLoaded_ = true;
 }
 
 const OnDemandReasonExtraData& SystemAbilityOnDemandReason::GetExtraData() const
 {
     return extraData_;
 }
-}
\ No newline at end of file
+
+bool SystemAbilityOnDemandReason::IsExtraDataLoaded() const
+{
+    return extraDataLoaded_;
+}
+
+bool SystemAbilityOnDemandReason::Marshalling(Parcel& parcel) const
+{
+    if (!parcel.WriteInt32(ONDEMAND_REASON_PARCEL_VERSION)) {
+        return false;
+    }
+    // the fields go to a scratch parcel first so that their size can precede them
+    Parcel fields;
+    if (!MarshallingFields(fields)) {
+        return false;
+    }
+    size_t size = fields.GetDataSize();
+    if (size > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+        return false;
+    }
+    if (!parcel.WriteInt32(static_cast<int32_t>(size))) {
+        return false;
+    }
+    return parcel.WriteBuffer(reinterpret_cast<const void*>(fields.GetData()), size);
+}
+
+bool SystemAbilityOnDemandReason::MarshallingFields(Parcel& parcel) const
+{
+    if (!parcel.WriteInt32(static_cast<int32_t>(reasonId_))) {
+        return false;
+    }
+    if (!parcel.WriteString(reasonName_)) {
+        return false;
+    }
+    if (!parcel.WriteString(reasonValue_)) {
+        return false;
+    }
+    if (!parcel.WriteInt64(extraDataId_)) {
+        return false;
+    }
+    if (!parcel.WriteBool(extraDataLoaded_)) {
+        return false;
+    }
+    if (extraDataLoaded_ && !extraData_.MarshallingCompact(parcel)) {
+        return false;
+    }
+    return true;
+}
+
+bool SystemAbilityOnDemandReason::Unmarshalling(Parcel& parcel, SystemAbilityOnDemandReason& reason)
+{
+    int32_t version = 0;
+    if (!parcel.ReadInt32(version) || version < MIN_REASON_PARCEL_VERSION) {
+        return false;
+    }
+    size_t fieldsEnd = 0;
+    if (version >= SIZED_REASON_PARCEL_VERSION) {
+        int32_t size = 0;
+        if (!parcel.ReadInt32(size) || size < 0 || static_cast<size_t>(size) > parcel.GetReadableBytes()) {
+            return false;
+        }
+        fieldsEnd = parcel.GetReadPosition() + static_cast<size_t>(size);
+    }
+    int32_t reasonId = 0;
+    if (!parcel.ReadInt32(reasonId)) {
+        return false;
+    }
+    std::string reasonName;
+    if (!parcel.ReadString(reasonName)) {
+        return false;
+    }
+    std::string reasonValue;
+    if (!parcel.ReadString(reasonValue)) {
+        return false;
+    }
+    int64_t extraDataId = -1;
+    if (!parcel.ReadInt64(extraDataId)) {
+        return false;
+    }
+    bool extraDataLoaded = false;
+    OnDemandReasonExtraData extraData;
+    if (version >= INLINE_EXTRA_DATA_PARCEL_VERSION) {
+        if (!parcel.ReadBool(extraDataLoaded)) {
+            return false;
+        }
+        if (extraDataLoaded && !OnDemandReasonExtraData::UnmarshallingCompact(parcel, extraData)) {
+            return false;
+        }
+        // fields appended by later versions are skipped, reading past the size means a corrupt parcel
+        if (parcel.GetReadPosition() > fieldsEnd || !parcel.RewindRead(fieldsEnd)) {
+            return false;
+        }
+    }
+    reason.reasonId_ = static_cast<OnDemandReasonId>(reasonId);
+    reason.reasonName_ = std::move(reasonName);
+    reason.reasonValue_ = std::move(reasonValue);
+    reason.extraDataId_ = extraDataId;
+    if (extraDataLoaded) {
+        reason.SetExtraData(extraData);
+    }
+    return true;
+}
+}
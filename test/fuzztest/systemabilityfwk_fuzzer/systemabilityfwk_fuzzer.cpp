@@ -111,7 +111,10 @@ void FuzzStartTimedQuery()
     LocalAbilityManager::GetInstance().NoNeedCheckUnused(systemAbilityId);
     int32_t timeout = GetData<int32_t>();
     LocalAbilityManager::GetInstance().LimitUnusedTimeout(systemAbilityId, timeout);
-    LocalAbilityManager::GetInstance().unusedCfgMap_.erase(systemAbilityId);
+    auto record = LocalAbilityManager::GetInstance().FindSaRecordLocked(systemAbilityId);
+    if (record != nullptr) {
+        record->unusedTimeout = 0;
+    }
 }
 
 void FuzzPhaseTasks()
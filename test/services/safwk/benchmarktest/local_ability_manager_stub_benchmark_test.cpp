@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "if_local_ability_manager.h"
+#include "local_ability_manager.h"
+#include "local_ability_manager_stub.h"
+#include "message_option.h"
+#include "message_parcel.h"
+
+namespace OHOS {
+namespace {
+constexpr uint32_t UNKNOWN_CODE = 0;
+
+// Each request fails right after dispatch, so the loop measures token check, permission check and handler lookup.
+void BenchmarkOnRemoteRequest(benchmark::State& state, uint32_t code)
+{
+    auto& manager = LocalAbilityManager::GetInstance();
+    MessageOption option;
+    for (auto _ : state) {
+        MessageParcel data;
+        MessageParcel reply;
+        data.WriteInterfaceToken(LOCAL_ABILITY_MANAGER_INTERFACE_TOKEN);
+        benchmark::DoNotOptimize(manager.OnRemoteRequest(code, data, reply, option));
+    }
+}
+}
+
+BENCHMARK_CAPTURE(BenchmarkOnRemoteRequest, StartAbility,
+    static_cast<uint32_t>(SafwkInterfaceCode::START_ABILITY_TRANSACTION));
+BENCHMARK_CAPTURE(BenchmarkOnRemoteRequest, ServiceControlCmd,
+    static_cast<uint32_t>(SafwkInterfaceCode::SERVICE_CONTROL_CMD_TRANSACTION));
+BENCHMARK_CAPTURE(BenchmarkOnRemoteRequest, BatchLifecycle,
+    static_cast<uint32_t>(SafwkBinaryInterfaceCode::BATCH_LIFECYCLE_TRANSACTION));
+BENCHMARK_CAPTURE(BenchmarkOnRemoteRequest, UnknownCode, UNKNOWN_CODE);
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+
+#include "ffrt_handler.h"
+#include "ffrt_task_stats.h"
+#include "gtest/gtest.h"
+#include "test_log.h"
+
+using namespace testing;
+using namespace testing::ext;
+
+namespace OHOS {
+namespace {
+    constexpr int32_t WAIT_SECONDS = 2;
+    constexpr int32_t RETRY_NUM = 100;
+    constexpr int32_t RETRY_INTERVAL_MS = 10;
+}
+
+class FfrtTaskStatsTest : public testing::Test {
+public:
+    static void SetUpTestCase();
+    static void TearDownTestCase();
+    void SetUp();
+    void TearDown();
+};
+
+void FfrtTaskStatsTest::SetUpTestCase()
+{
+    DTEST_LOG << "SetUpTestCase" << std::endl;
+}
+
+void FfrtTaskStatsTest::TearDownTestCase()
+{
+    DTEST_LOG << "TearDownTestCase" << std::endl;
+}
+
+void FfrtTaskStatsTest::SetUp()
+{
+    FfrtTaskStats::GetInstance().Reset();
+    DTEST_LOG << "SetUp" << std::endl;
+}
+
+void FfrtTaskStatsTest::TearDown()
+{
+    DTEST_LOG << "TearDown" << std::endl;
+}
+
+/**
+ * @tc.name: Record001
+ * @tc.desc: test records are aggregated per task name and ordered by total time
+ * @tc.type: FUNC
+ */
+HWTEST_F(FfrtTaskStatsTest, Record001, TestSize.Level2)
+{
+    DTEST_LOG << "Record001 start" << std::endl;
+    constexpr uint64_t shortTime = 10;
+    constexpr uint64_t longTime = 100;
+    FfrtTaskStats::GetInstance().Record("shortTask", 0, shortTime);
+    FfrtTaskStats::GetInstance().Record("shortTask", 0, shortTime);
+    FfrtTaskStats::GetInstance().Record("longTask", 0, longTime);
+    std::string result;
+    FfrtTaskStats::GetInstance().Dump(result);
+    EXPECT_EQ(result.find("scope:"), 0);
+    EXPECT_EQ(result.find("tasks:3 taskNames:2\n"), result.find('\n') + 1);
+    size_t longPos = result.find("longTask sum:100 count:1");
+    size_t shortPos = result.find("shortTask sum:20 count:2");
+    EXPECT_NE(longPos, std::string::npos);
+    EXPECT_NE(shortPos, std::string::npos);
+    EXPECT_LT(longPos, shortPos);
+    DTEST_LOG << "Record001 end" << std::endl;
+}
+
+/**
+ * @tc.name: Record002
+ * @tc.desc: test the ring keeps only the latest RING_SIZE tasks
+ * @tc.type: FUNC
+ */
+HWTEST_F(FfrtTaskStatsTest, Record002, TestSize.Level2)
+{
+    DTEST_LOG << "Record002 start" << std::endl;
+    uint64_t total = FfrtTaskStats::RING_SIZE + 1;
+    for (uint64_t i = 0; i < total; ++i) {
+        FfrtTaskStats::GetInstance().Record("ringTask", i, i + 1);
+    }
+    std::string result;
+    FfrtTaskStats::GetInstance().Dump(result);
+    EXPECT_EQ(result.find("\nringTask 0 1\n"), std::string::npos);
+    EXPECT_NE(result.find("\nringTask 1 2\n"), std::string::npos);
+    EXPECT_NE(result.find("\nringTask " + std::to_string(total - 1)), std::string::npos);
+    FfrtTaskStats::GetInstance().Reset();
+    result.clear();
+    FfrtTaskStats::GetInstance().Dump(result);
+    EXPECT_EQ(result.find("tasks:0 taskNames:0\n"), result.find('\n') + 1);
+    DTEST_LOG << "Record002 end" << std::endl;
+}
+
+/**
+ * @tc.name: PostTask001
+ * @tc.desc: test tasks posted through FFRTHandler are recorded when they finish
+ * @tc.type: FUNC
+ */
+HWTEST_F(FfrtTaskStatsTest, PostTask001, TestSize.Level2)
+{
+    DTEST_LOG << "PostTask001 start" << std::endl;
+    auto handler = std::make_shared<FFRTHandler>("FfrtTaskStatsTest");
+    auto done = std::make_shared<std::promise<void>>();
+    std::future<void> future = done->get_future();
+    EXPECT_TRUE(handler->PostTask([done]() { done->set_value(); }, "statsTask", 0));
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(WAIT_SECONDS)), std::future_status::ready);
+    // the task is recorded right after it returns, which may be later than the promise is set
+    std::string result;
+    for (int32_t i = 0; i < RETRY_NUM && result.find("statsTask sum:") == std::string::npos; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(RETRY_INTERVAL_MS));
+        result.clear();
+        FfrtTaskStats::GetInstance().Dump(result);
+    }
+    EXPECT_NE(result.find("statsTask sum:"), std::string::npos);
+    DTEST_LOG << "PostTask001 end" << std::endl;
+}
+}
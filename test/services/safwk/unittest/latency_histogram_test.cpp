@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "latency_histogram.h"
+#include "test_log.h"
+
+using namespace testing;
+using namespace testing::ext;
+
+namespace OHOS {
+namespace {
+    constexpr uint64_t SAMPLE_NUM = 1000;
+    constexpr uint64_t MAX_CHECKED_DURATION = 1 << 20;
+}
+
+class LatencyHistogramTest : public testing::Test {
+public:
+    static void SetUpTestCase();
+    static void TearDownTestCase();
+    void SetUp();
+    void TearDown();
+};
+
+void LatencyHistogramTest::SetUpTestCase()
+{
+    DTEST_LOG << "SetUpTestCase" << std::endl;
+}
+
+void LatencyHistogramTest::TearDownTestCase()
+{
+    DTEST_LOG << "TearDownTestCase" << std::endl;
+}
+
+void LatencyHistogramTest::SetUp()
+{
+    DTEST_LOG << "SetUp" << std::endl;
+}
+
+void LatencyHistogramTest::TearDown()
+{
+    DTEST_LOG << "TearDown" << std::endl;
+}
+
+/**
+ * @tc.name: GetBucketIndex001
+ * @tc.desc: test every duration falls into the bucket whose bounds contain it
+ * @tc.type: FUNC
+ */
+HWTEST_F(LatencyHistogramTest, GetBucketIndex001, TestSize.Level2)
+{
+    DTEST_LOG << "GetBucketIndex001 start" << std::endl;
+    for (uint64_t duration = 0; duration < MAX_CHECKED_DURATION; ++duration) {
+        uint32_t index = LatencyHistogram::GetBucketIndex(duration);
+        ASSERT_LE(duration, LatencyHistogram::GetBucketUpperBound(index));
+        if (index > 0) {
+            ASSERT_GT(duration, LatencyHistogram::GetBucketUpperBound(index - 1));
+        }
+    }
+    EXPECT_EQ(LatencyHistogram::GetBucketIndex(UINT64_MAX), LatencyHistogram::BUCKET_NUM - 1);
+    EXPECT_EQ(LatencyHistogram::GetBucketIndex((1ULL << LatencyHistogram::MAX_EXPONENT) - 1),
+        LatencyHistogram::BUCKET_NUM - 2);
+    DTEST_LOG << "GetBucketIndex001 end" << std::endl;
+}
+
+/**
+ * @tc.name: GetSummary001
+ * @tc.desc: test percentiles stay within one sub bucket of the exact value, and Reset clears them
+ * @tc.type: FUNC
+ */
+HWTEST_F(LatencyHistogramTest, GetSummary001, TestSize.Level2)
+{
+    DTEST_LOG << "GetSummary001 start" << std::endl;
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.GetSummary().count, 0);
+    for (uint64_t duration = 1; duration <= SAMPLE_NUM; ++duration) {
+        histogram.Record(duration);
+    }
+    auto summary = histogram.GetSummary();
+    EXPECT_EQ(summary.count, SAMPLE_NUM);
+    EXPECT_EQ(summary.sum, SAMPLE_NUM * (SAMPLE_NUM + 1) / 2);
+    EXPECT_EQ(summary.max, SAMPLE_NUM);
+    EXPECT_GE(summary.p50, 500);
+    EXPECT_LE(summary.p50, 500 + 500 / LatencyHistogram::SUB_BUCKET_NUM);
+    EXPECT_GE(summary.p99, 990);
+    EXPECT_LE(summary.p999, SAMPLE_NUM);
+    std::string result;
+    LatencyHistogram::FormatSummary(summary, result);
+    EXPECT_NE(result.find("count:1000"), std::string::npos);
+    histogram.Reset();
+    summary = histogram.GetSummary();
+    EXPECT_EQ(summary.count, 0);
+    EXPECT_EQ(summary.max, 0);
+    DTEST_LOG << "GetSummary001 end" << std::endl;
+}
+}
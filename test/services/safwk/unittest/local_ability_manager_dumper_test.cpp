@@ -13,12 +13,15 @@
  * limitations under the License.
  */
 
+#include <cstring>
+
 #include "gtest/gtest.h"
 #include "test_log.h"
 #include "ffrt_inner.h"
 
 #define private public
 #include "local_ability_manager_dumper.h"
+#include "local_ability_manager_stub.h"
 
 using namespace std;
 using namespace testing;
@@ -98,6 +101,69 @@ HWTEST_F(LocalAbilityManagerDumperTest, GetIpcStatistics001, TestSize.Level2)
     DTEST_LOG << "GetIpcStatistics001 end" << std::endl;
 }
 
+/**
+ * @tc.name: WriteIpcStatistics001
+ * @tc.desc: test WriteIpcStatistics streams the text and the CSV form
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerDumperTest, WriteIpcStatistics001, TestSize.Level2)
+{
+    DTEST_LOG << "WriteIpcStatistics001 start" << std::endl;
+    std::string text;
+    EXPECT_TRUE(LocalAbilityManagerDumper::GetIpcStatistics(text));
+    int32_t fds[2] = {-1, -1};
+    ASSERT_EQ(pipe(fds), 0);
+    {
+        StatWriter writer(fds[1]);
+        EXPECT_TRUE(LocalAbilityManagerDumper::WriteIpcStatistics(writer, false));
+        EXPECT_TRUE(writer.Flush());
+    }
+    close(fds[1]);
+    std::string streamed;
+    char buf[StatWriter::BUFFER_SIZE];
+    ssize_t len = 0;
+    while ((len = read(fds[0], buf, sizeof(buf))) > 0) {
+        streamed.append(buf, len);
+    }
+    close(fds[0]);
+    EXPECT_EQ(streamed.substr(0, streamed.find('\n')), text.substr(0, text.find('\n')));
+    std::string csv;
+    {
+        StatWriter writer(csv);
+        EXPECT_TRUE(LocalAbilityManagerDumper::WriteIpcStatistics(writer, true));
+    }
+    EXPECT_EQ(csv.find("pid,callingPid,descriptor,code,count,totalCost,maxCost,minCost,avgCost\n"), 0);
+    DTEST_LOG << "WriteIpcStatistics001 end" << std::endl;
+}
+
+/**
+ * @tc.name: StatWriter001
+ * @tc.desc: test StatWriter quotes CSV fields and passes through data larger than its buffer
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerDumperTest, StatWriter001, TestSize.Level2)
+{
+    DTEST_LOG << "StatWriter001 start" << std::endl;
+    std::string result;
+    {
+        StatWriter writer(result);
+        writer.AppendNumber(-1).Append(',').AppendCsvField("a,\"b\"").Append(',').AppendCsvField("c");
+    }
+    EXPECT_EQ(result, "-1,\"a,\"\"b\"\"\",c");
+    result.clear();
+    std::string large(StatWriter::BUFFER_SIZE * 2, 'x');
+    {
+        StatWriter writer(result);
+        writer.Append("head").Append(large).Append('z');
+    }
+    EXPECT_EQ(result, "head" + large + "z");
+    StatWriter badWriter(-1);
+    badWriter.Append("data");
+    EXPECT_FALSE(badWriter.Flush());
+    EXPECT_TRUE(badWriter.IsFailed());
+    DTEST_LOG << "StatWriter001 end" << std::endl;
+}
+
 /**
  * @tc.name: CollectFfrtStatistics001
  * @tc.desc: CollectFfrtStatistics
@@ -139,4 +205,35 @@ HWTEST_F(LocalAbilityManagerDumperTest, CollectFfrtStatistics001, TestSize.Level
     EXPECT_TRUE(ret);
     DTEST_LOG << "CollectFfrtStatistics001 end" << std::endl;
 }
+
+/**
+ * @tc.name: FfrtStatisticsParser001
+ * @tc.desc: test FfrtStatisticsParser groups the tasks by name and ranks them by total time
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerDumperTest, FfrtStatisticsParser001, TestSize.Level2)
+{
+    DTEST_LOG << "FfrtStatisticsParser001 start" << std::endl;
+    constexpr int32_t statNum = 4;
+    // the zeroed last record ends the parse
+    LocalAbilityManagerDumper::ffrtMetricBuffer = new char[sizeof(ffrt_stat) * statNum]();
+    ffrt_stat* stats = reinterpret_cast<ffrt_stat*>(LocalAbilityManagerDumper::ffrtMetricBuffer);
+    const char* names[] = {"shortTask", "shortTask", "longTask"};
+    const uint64_t durations[] = {10, 20, 100};
+    for (int32_t i = 0; i < statNum - 1; ++i) {
+        std::strncpy(stats[i].taskName, names[i], sizeof(stats[i].taskName) - 1);
+        stats[i].startTime = 0;
+        stats[i].endTime = durations[i];
+    }
+    std::string result;
+    LocalAbilityManagerDumper::FfrtStatisticsParser(result);
+    LocalAbilityManagerDumper::ClearFfrtStatisticsBufferLocked();
+    EXPECT_NE(result.find("top 2 of 2 taskNames"), std::string::npos);
+    size_t longPos = result.find("longTask sum:100 count:1");
+    size_t shortPos = result.find("shortTask sum:30 count:2");
+    EXPECT_NE(longPos, std::string::npos);
+    EXPECT_NE(shortPos, std::string::npos);
+    EXPECT_LT(longPos, shortPos);
+    DTEST_LOG << "FfrtStatisticsParser001 end" << std::endl;
+}
 }
\ No newline at end of file
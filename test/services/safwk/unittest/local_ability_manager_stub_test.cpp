@@ -42,6 +42,20 @@ namespace {
     constexpr const char* EXTRA_DATA_ID = "extraDataId";
 }
 
+class ExtReplyCallback : public IPCObjectStub {
+public:
+    int OnRemoteRequest(uint32_t code, MessageParcel& data, MessageParcel& reply, MessageOption& option) override
+    {
+        code_ = code;
+        result_ = data.ReadInt32();
+        replyNum_++;
+        return ERR_NONE;
+    }
+    uint32_t code_ = 0;
+    int32_t result_ = 0;
+    int32_t replyNum_ = 0;
+};
+
 class LocalAbilityManagerStubTest : public testing::Test {
 public:
     static void SetUpTestCase();
@@ -194,9 +208,9 @@ HWTEST_F(LocalAbilityManagerStubTest, OnRemoteRequest006, TestSize.Level2)
     MessageParcel reply;
     MessageOption option;
     uint32_t code = 1;
-    auto iter = LocalAbilityManager::GetInstance().memberFuncMap_.find(code);
+    auto handler = LocalAbilityManager::GetInstance().GetStubHandler(code);
     LocalAbilityManager::GetInstance().OnRemoteRequest(code, data, reply, option);
-    EXPECT_NE(iter, LocalAbilityManager::GetInstance().memberFuncMap_.end());
+    EXPECT_NE(handler, nullptr);
     DTEST_LOG << "OnRemoteRequest006 end" << std::endl;
 }
 
@@ -216,12 +230,46 @@ HWTEST_F(LocalAbilityManagerStubTest, OnRemoteRequest007, TestSize.Level2)
     MessageParcel reply;
     MessageOption option;
     uint32_t code = 0;
-    auto iter = LocalAbilityManager::GetInstance().memberFuncMap_.find(code);
+    auto handler = LocalAbilityManager::GetInstance().GetStubHandler(code);
     LocalAbilityManager::GetInstance().OnRemoteRequest(code, data, reply, option);
-    EXPECT_EQ(iter, LocalAbilityManager::GetInstance().memberFuncMap_.end());
+    EXPECT_EQ(handler, nullptr);
     DTEST_LOG << "OnRemoteRequest007 end" << std::endl;
 }
 
+/**
+ * @tc.name: GetStubHandler001
+ * @tc.desc: test GetStubHandler, every served code has a handler and its permission, others have none
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerStubTest, GetStubHandler001, TestSize.Level2)
+{
+    DTEST_LOG << "GetStubHandler001 start" << std::endl;
+    auto& stub = LocalAbilityManager::GetInstance();
+    for (uint32_t code = static_cast<uint32_t>(SafwkInterfaceCode::START_ABILITY_TRANSACTION);
+        code <= static_cast<uint32_t>(SafwkInterfaceCode::FFRT_STAT_CMD_TRANSACTION); ++code) {
+        auto handler = stub.GetStubHandler(code);
+        ASSERT_NE(handler, nullptr);
+        EXPECT_NE(handler->func, nullptr);
+        EXPECT_NE(handler->permission, nullptr);
+    }
+    for (uint32_t code = static_cast<uint32_t>(SafwkBinaryInterfaceCode::QUERY_PROTOCOL_TRANSACTION);
+        code <= static_cast<uint32_t>(SafwkBinaryInterfaceCode::SAFWK_TASK_STAT_CMD_TRANSACTION); ++code) {
+        EXPECT_NE(stub.GetStubHandler(code), nullptr);
+    }
+    auto extHandler = stub.GetStubHandler(static_cast<uint32_t>(SafwkInterfaceCode::SYSTEM_ABILITY_EXT_TRANSACTION));
+    ASSERT_NE(extHandler, nullptr);
+    EXPECT_EQ(*extHandler->permission, "ohos.permission.ACCESS_EXT_SYSTEM_ABILITY");
+    auto svcHandler = stub.GetStubHandler(static_cast<uint32_t>(SafwkInterfaceCode::SERVICE_CONTROL_CMD_TRANSACTION));
+    ASSERT_NE(svcHandler, nullptr);
+    EXPECT_EQ(*svcHandler->permission, "ohos.permission.CONTROL_SVC_CMD");
+    uint32_t afterBinaryCode = static_cast<uint32_t>(SafwkBinaryInterfaceCode::SAFWK_TASK_STAT_CMD_TRANSACTION) + 1;
+    EXPECT_EQ(stub.GetStubHandler(afterBinaryCode), nullptr);
+    uint32_t beforeBinaryCode = static_cast<uint32_t>(SafwkBinaryInterfaceCode::QUERY_PROTOCOL_TRANSACTION) - 1;
+    EXPECT_EQ(stub.GetStubHandler(beforeBinaryCode), nullptr);
+    EXPECT_EQ(stub.GetStubHandler(UINT32_MAX), nullptr);
+    DTEST_LOG << "GetStubHandler001 end" << std::endl;
+}
+
 /**
  * @tc.name: StartAbilityInner001
  * @tc.desc: test StartAbilityInner with invalid SaID
@@ -396,6 +444,170 @@ HWTEST_F(LocalAbilityManagerStubTest, IdleAbilityInner002, TestSize.Level2)
     DTEST_LOG << "IdleAbilityInner002 end" << std::endl;
 }
 
+/**
+ * @tc.name: QueryProtocolInner001
+ * @tc.desc: test QueryProtocolInner, reply the binary protocol version
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerStubTest, QueryProtocolInner001, TestSize.Level2)
+{
+    DTEST_LOG << "QueryProtocolInner001 start" << std::endl;
+    MessageParcel data;
+    MessageParcel reply;
+    int32_t ret = LocalAbilityManager::GetInstance().QueryProtocolInner(data, reply);
+    EXPECT_EQ(ret, ERR_NONE);
+    EXPECT_EQ(reply.ReadInt32(), LOCAL_ABILITY_PROTOCOL_VERSION);
+    DTEST_LOG << "QueryProtocolInner001 end" << std::endl;
+}
+
+/**
+ * @tc.name: StartAbilityBinaryInner001
+ * @tc.desc: test StartAbilityBinaryInner with invalid SaID and without reason
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerStubTest, StartAbilityBinaryInner001, TestSize.Level2)
+{
+    DTEST_LOG << "StartAbilityBinaryInner001 start" << std::endl;
+    MessageParcel data;
+    data.WriteInt32(INVALID_SAID);
+    MessageParcel reply;
+    int32_t ret = LocalAbilityManager::GetInstance().StartAbilityBinaryInner(data, reply);
+    EXPECT_EQ(ret, ERR_NULL_OBJECT);
+    MessageParcel noReasonData;
+    noReasonData.WriteInt32(STARTCODE);
+    ret = LocalAbilityManager::GetInstance().StartAbilityBinaryInner(noReasonData, reply);
+    EXPECT_EQ(ret, ERR_NULL_OBJECT);
+    DTEST_LOG << "StartAbilityBinaryInner001 end" << std::endl;
+}
+
+/**
+ * @tc.name: IdleAbilityBinaryInner001
+ * @tc.desc: test IdleAbilityBinaryInner with valid SaID and binary reason
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerStubTest, IdleAbilityBinaryInner001, TestSize.Level2)
+{
+    DTEST_LOG << "IdleAbilityBinaryInner001 start" << std::endl;
+    MessageParcel data;
+    data.WriteInt32(STARTCODE);
+    SystemAbilityOnDemandReason idleReason(OnDemandReasonId::PARAM, "test", "test", -1);
+    EXPECT_TRUE(idleReason.Marshalling(data));
+    MessageParcel reply;
+    int32_t ret = LocalAbilityManager::GetInstance().IdleAbilityBinaryInner(data, reply);
+    EXPECT_EQ(ret, ERR_NONE);
+    EXPECT_FALSE(reply.ReadBool());
+    DTEST_LOG << "IdleAbilityBinaryInner001 end" << std::endl;
+}
+
+/**
+ * @tc.name: BatchLifecycleInner001
+ * @tc.desc: test BatchLifecycleInner, invalid num, op or reason rejects the batch
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerStubTest, BatchLifecycleInner001, TestSize.Level2)
+{
+    DTEST_LOG << "BatchLifecycleInner001 start" << std::endl;
+    MessageParcel reply;
+    MessageParcel emptyData;
+    emptyData.WriteInt32(0);
+    EXPECT_EQ(LocalAbilityManager::GetInstance().BatchLifecycleInner(emptyData, reply), ERR_NULL_OBJECT);
+    MessageParcel tooManyData;
+    tooManyData.WriteInt32(MAX_LIFECYCLE_BATCH_NUM + 1);
+    EXPECT_EQ(LocalAbilityManager::GetInstance().BatchLifecycleInner(tooManyData, reply), ERR_NULL_OBJECT);
+    MessageParcel invalidOpData;
+    invalidOpData.WriteInt32(1);
+    invalidOpData.WriteInt32(STARTCODE);
+    invalidOpData.WriteInt32(static_cast<int32_t>(SaLifecycleOp::IDLE) + 1);
+    EXPECT_EQ(LocalAbilityManager::GetInstance().BatchLifecycleInner(invalidOpData, reply), ERR_NULL_OBJECT);
+    MessageParcel noReasonData;
+    noReasonData.WriteInt32(1);
+    noReasonData.WriteInt32(STARTCODE);
+    noReasonData.WriteInt32(static_cast<int32_t>(SaLifecycleOp::ACTIVE));
+    EXPECT_EQ(LocalAbilityManager::GetInstance().BatchLifecycleInner(noReasonData, reply), ERR_NULL_OBJECT);
+    DTEST_LOG << "BatchLifecycleInner001 end" << std::endl;
+}
+
+/**
+ * @tc.name: BatchLifecycleInner002
+ * @tc.desc: test BatchLifecycleInner, every entry gets its own result
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerStubTest, BatchLifecycleInner002, TestSize.Level2)
+{
+    DTEST_LOG << "BatchLifecycleInner002 start" << std::endl;
+    MessageParcel data;
+    data.WriteInt32(2);
+    SystemAbilityOnDemandReason reason(OnDemandReasonId::PARAM, "test", "test", -1);
+    data.WriteInt32(STARTCODE);
+    data.WriteInt32(static_cast<int32_t>(SaLifecycleOp::ACTIVE));
+    EXPECT_TRUE(reason.Marshalling(data));
+    data.WriteInt32(STARTCODE);
+    data.WriteInt32(static_cast<int32_t>(SaLifecycleOp::IDLE));
+    EXPECT_TRUE(reason.Marshalling(data));
+    MessageParcel reply;
+    int32_t ret = LocalAbilityManager::GetInstance().BatchLifecycleInner(data, reply);
+    EXPECT_EQ(ret, ERR_NONE);
+    EXPECT_EQ(reply.ReadInt32(), 2);
+    EXPECT_FALSE(reply.ReadBool());
+    EXPECT_EQ(reply.ReadInt32(), 0);
+    EXPECT_FALSE(reply.ReadBool());
+    EXPECT_EQ(reply.ReadInt32(), 0);
+    DTEST_LOG << "BatchLifecycleInner002 end" << std::endl;
+}
+
+/**
+ * @tc.name: SystemAbilityExtAsyncInner001
+ * @tc.desc: test SystemAbilityExtAsyncInner, invalid requests are completed through the callback
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerStubTest, SystemAbilityExtAsyncInner001, TestSize.Level2)
+{
+    DTEST_LOG << "SystemAbilityExtAsyncInner001 start" << std::endl;
+    MessageParcel reply;
+    MessageParcel noCallbackData;
+    noCallbackData.WriteInt32(SAID);
+    noCallbackData.WriteString("ext");
+    int32_t ret = LocalAbilityManager::GetInstance().SystemAbilityExtAsyncInner(noCallbackData, reply);
+    EXPECT_EQ(ret, INVALID_DATA);
+    sptr<ExtReplyCallback> callback = new ExtReplyCallback();
+    MessageParcel invalidSaData;
+    invalidSaData.WriteInt32(INVALID_SAID);
+    invalidSaData.WriteString("ext");
+    invalidSaData.WriteRemoteObject(callback);
+    ret = LocalAbilityManager::GetInstance().SystemAbilityExtAsyncInner(invalidSaData, reply);
+    EXPECT_EQ(ret, INVALID_DATA);
+    EXPECT_EQ(callback->replyNum_, 1);
+    EXPECT_EQ(callback->code_, SA_EXTENSION_REPLY_CODE);
+    EXPECT_EQ(callback->result_, INVALID_DATA);
+    DTEST_LOG << "SystemAbilityExtAsyncInner001 end" << std::endl;
+}
+
+/**
+ * @tc.name: SystemAbilityExtensionReply001
+ * @tc.desc: test SystemAbilityExtensionReply, completed once and completed on drop
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerStubTest, SystemAbilityExtensionReply001, TestSize.Level2)
+{
+    DTEST_LOG << "SystemAbilityExtensionReply001 start" << std::endl;
+    sptr<ExtReplyCallback> callback = new ExtReplyCallback();
+    {
+        SystemAbilityExtensionReply extReply(SAID, "ext", callback);
+        extReply.GetReply().WriteInt32(STARTCODE);
+        EXPECT_TRUE(extReply.Complete(ERR_NONE));
+        EXPECT_TRUE(extReply.IsCompleted());
+        EXPECT_FALSE(extReply.Complete(INVALID_DATA));
+    }
+    EXPECT_EQ(callback->replyNum_, 1);
+    EXPECT_EQ(callback->result_, ERR_NONE);
+    {
+        SystemAbilityExtensionReply droppedReply(SAID, "ext", callback);
+    }
+    EXPECT_EQ(callback->replyNum_, 2);
+    EXPECT_EQ(callback->result_, ERR_INVALID_STATE);
+    DTEST_LOG << "SystemAbilityExtensionReply001 end" << std::endl;
+}
+
 /**
  * @tc.name: OnStopAbility001
  * @tc.desc: test OnStopAbility, cover function with valid SaID
@@ -413,7 +625,7 @@ HWTEST_F(LocalAbilityManagerStubTest, OnStopAbility001, TestSize.Level2)
 
 /**
  * @tc.name: OnStopAbility002
- * @tc.desc: test OnStopAbility with said is in localAbilityMap_
+ * @tc.desc: test OnStopAbility with said is in saRecords_
  * @tc.type: FUNC
  * @tc.require: I7G7DL
  */
@@ -422,7 +634,8 @@ HWTEST_F(LocalAbilityManagerStubTest, OnStopAbility002, TestSize.Level2)
     DTEST_LOG << "OnStopAbility002 start" << std::endl;
     MockSaRealize *mockSa = new MockSaRealize(SAID, false);
     mockSa->abilityState_ = SystemAbilityState::NOT_LOADED;
-    LocalAbilityManager::GetInstance().localAbilityMap_[SAID] = mockSa;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(SAID).ability = mockSa;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     bool ret = LocalAbilityManager::GetInstance().OnStopAbility(SAID);
     delete mockSa;
     EXPECT_TRUE(ret);
@@ -459,7 +672,8 @@ HWTEST_F(LocalAbilityManagerStubTest, ActiveAbility002, TestSize.Level2)
     DTEST_LOG << "ActiveAbility002 start" << std::endl;
     nlohmann::json activeReason;
     MockSaRealize *mockSa = new MockSaRealize(SAID, false);
-    LocalAbilityManager::GetInstance().localAbilityMap_[SAID] = mockSa;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(SAID).ability = mockSa;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     mockSa->abilityState_ = SystemAbilityState::ACTIVE;
     bool ret = LocalAbilityManager::GetInstance().ActiveAbility(SAID, activeReason);
     delete mockSa;
@@ -499,7 +713,8 @@ HWTEST_F(LocalAbilityManagerStubTest, IdleAbility002, TestSize.Level2)
     DTEST_LOG << "IdleAbility002 start" << std::endl;
     nlohmann::json idleReason;
     MockSaRealize *mockSa = new MockSaRealize(SAID, false);
-    LocalAbilityManager::GetInstance().localAbilityMap_[SAID] = mockSa;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(SAID).ability = mockSa;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     mockSa->abilityState_ = SystemAbilityState::IDLE;
     int delayTime = 0;
     bool ret = LocalAbilityManager::GetInstance().IdleAbility(SAID, idleReason, delayTime);
@@ -532,6 +747,66 @@ HWTEST_F(LocalAbilityManagerStubTest, JsonToOnDemandReason001, TestSize.Level2)
     DTEST_LOG << "JsonToOnDemandReason001 end" << std::endl;
 }
 
+/**
+ * @tc.name: ParseOnDemandReason001
+ * @tc.desc: test ParseOnDemandReason, top level fields are read and nested ones ignored
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerStubTest, ParseOnDemandReason001, TestSize.Level2)
+{
+    DTEST_LOG << "ParseOnDemandReason001 start" << std::endl;
+    std::string eventStr = "{\"eventId\":4,\"name\":\"usual.event.SCREEN_ON\",\"value\":\"on\","
+        "\"extra\":{\"name\":\"nested\",\"extraDataId\":7},\"extraDataId\":12}";
+    SystemAbilityOnDemandReason reason;
+    bool ret = LocalAbilityManagerStub::ParseOnDemandReason(eventStr, reason);
+    EXPECT_TRUE(ret);
+    EXPECT_EQ(reason.GetId(), OnDemandReasonId::COMMON_EVENT);
+    EXPECT_EQ(reason.GetName(), "usual.event.SCREEN_ON");
+    EXPECT_EQ(reason.GetValue(), "on");
+    EXPECT_EQ(reason.GetExtraDataId(), 12);
+    DTEST_LOG << "ParseOnDemandReason001 end" << std::endl;
+}
+
+/**
+ * @tc.name: ParseOnDemandReason002
+ * @tc.desc: test ParseOnDemandReason, invalid event string leaves the reason untouched
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerStubTest, ParseOnDemandReason002, TestSize.Level2)
+{
+    DTEST_LOG << "ParseOnDemandReason002 start" << std::endl;
+    SystemAbilityOnDemandReason reason;
+    bool ret = LocalAbilityManagerStub::ParseOnDemandReason("{\"name\":\"test\",", reason);
+    EXPECT_FALSE(ret);
+    EXPECT_EQ(reason.GetName(), "");
+    EXPECT_EQ(reason.GetExtraDataId(), -1);
+    DTEST_LOG << "ParseOnDemandReason002 end" << std::endl;
+}
+
+/**
+ * @tc.name: ParseOnDemandReason003
+ * @tc.desc: test ParseOnDemandReason, a float id is truncated and only a reason field out of the int64 range fails
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerStubTest, ParseOnDemandReason003, TestSize.Level2)
+{
+    DTEST_LOG << "ParseOnDemandReason003 start" << std::endl;
+    SystemAbilityOnDemandReason reason;
+    EXPECT_TRUE(LocalAbilityManagerStub::ParseOnDemandReason("{\"eventId\":4.0,\"extraDataId\":12.5}", reason));
+    EXPECT_EQ(reason.GetId(), OnDemandReasonId::COMMON_EVENT);
+    EXPECT_EQ(reason.GetExtraDataId(), 12);
+    SystemAbilityOnDemandReason rangeReason;
+    EXPECT_FALSE(LocalAbilityManagerStub::ParseOnDemandReason("{\"extraDataId\":1e300}", rangeReason));
+    EXPECT_FALSE(LocalAbilityManagerStub::ParseOnDemandReason("{\"extraDataId\":-1e19}", rangeReason));
+    EXPECT_EQ(rangeReason.GetExtraDataId(), -1);
+    SystemAbilityOnDemandReason ignoredReason;
+    EXPECT_TRUE(LocalAbilityManagerStub::ParseOnDemandReason(
+        "{\"eventId\":4,\"other\":1e300,\"nested\":{\"extraDataId\":-1e19}}", ignoredReason));
+    EXPECT_EQ(ignoredReason.GetId(), OnDemandReasonId::COMMON_EVENT);
+    EXPECT_EQ(ignoredReason.GetExtraDataId(), -1);
+    DTEST_LOG << "ParseOnDemandReason003 end" << std::endl;
+}
+
 /**
  * @tc.name: FfrtDumperProc001
  * @tc.desc: test FfrtDumperProc
@@ -547,6 +822,25 @@ HWTEST_F(LocalAbilityManagerStubTest, FfrtDumperProc001, TestSize.Level2)
     DTEST_LOG << "FfrtDumperProc001 end" << std::endl;
 }
 
+/**
+ * @tc.name: FfrtDumperProc002
+ * @tc.desc: test FfrtDumperProc appends only the dumped text and keeps working once ffrt_dump is cached
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerStubTest, FfrtDumperProc002, TestSize.Level2)
+{
+    DTEST_LOG << "FfrtDumperProc002 start" << std::endl;
+    const std::string prefix = "prefix\n";
+    for (int32_t i = 0; i < 2; ++i) {
+        std::string ffrtDumperInfo = prefix;
+        EXPECT_TRUE(LocalAbilityManager::GetInstance().FfrtDumperProc(ffrtDumperInfo));
+        EXPECT_EQ(ffrtDumperInfo.compare(0, prefix.size(), prefix), 0);
+        EXPECT_GT(ffrtDumperInfo.size(), prefix.size());
+        EXPECT_EQ(ffrtDumperInfo.find('\0'), std::string::npos);
+    }
+    DTEST_LOG << "FfrtDumperProc002 end" << std::endl;
+}
+
 /**
  * @tc.name: SendStrategyToSA001
  * @tc.desc: test SendStrategyToSA001, cover function with valid SaID
@@ -564,7 +858,7 @@ HWTEST_F(LocalAbilityManagerStubTest, SendStrategyToSA001, TestSize.Level2)
 
 /**
  * @tc.name: SendStrategyToSA002
- * @tc.desc: test SendStrategyToSA with said is in localAbilityMap_
+ * @tc.desc: test SendStrategyToSA with said is in saRecords_
  * @tc.type: FUNC
  */
 HWTEST_F(LocalAbilityManagerStubTest, SendStrategyToSA002, TestSize.Level2)
@@ -572,7 +866,8 @@ HWTEST_F(LocalAbilityManagerStubTest, SendStrategyToSA002, TestSize.Level2)
     DTEST_LOG << "SendStrategyToSA002 start" << std::endl;
     MockSaRealize *mockSa = new MockSaRealize(SAID, false);
     mockSa->abilityState_ = SystemAbilityState::NOT_LOADED;
-    LocalAbilityManager::GetInstance().localAbilityMap_[SAID] = mockSa;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(SAID).ability = mockSa;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     std::string action = "";
     bool ret = LocalAbilityManager::GetInstance().SendStrategyToSA(1, SAID, 1, action);
     delete mockSa;
@@ -654,6 +949,45 @@ HWTEST_F(LocalAbilityManagerStubTest, CheckPermission001, TestSize.Level2)
     DTEST_LOG << "CheckPermission001 end" << std::endl;
 }
 
+/**
+ * @tc.name: PermissionVerdictCache001
+ * @tc.desc: test PermissionVerdictCache, granted verdicts are kept until a permission change is notified
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerStubTest, PermissionVerdictCache001, TestSize.Level2)
+{
+    DTEST_LOG << "PermissionVerdictCache001 start" << std::endl;
+    PermissionVerdictCache cache;
+    cache.enabled_ = true;
+    const std::string permission = "ohos.permission.MANAGE_SYSTEM_ABILITY";
+    uint32_t tokenId = 1;
+    auto key = std::make_pair(tokenId, reinterpret_cast<uintptr_t>(&permission));
+    EXPECT_TRUE(cache.Verify(tokenId, permission));
+    EXPECT_NE(cache.verdicts_.Get(key), nullptr);
+    EXPECT_TRUE(cache.Verify(tokenId, permission));
+    cache.Invalidate();
+    EXPECT_EQ(cache.verdicts_.Get(key), nullptr);
+    EXPECT_EQ(cache.generation_.load(), 1);
+    DTEST_LOG << "PermissionVerdictCache001 end" << std::endl;
+}
+
+/**
+ * @tc.name: PermissionVerdictCache002
+ * @tc.desc: test PermissionVerdictCache keeps no verdict while the change notification is not set up
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerStubTest, PermissionVerdictCache002, TestSize.Level2)
+{
+    DTEST_LOG << "PermissionVerdictCache002 start" << std::endl;
+    PermissionVerdictCache cache;
+    const std::string permission = "ohos.permission.MANAGE_SYSTEM_ABILITY";
+    uint32_t tokenId = 1;
+    auto key = std::make_pair(tokenId, reinterpret_cast<uintptr_t>(&permission));
+    EXPECT_TRUE(cache.Verify(tokenId, permission));
+    EXPECT_EQ(cache.verdicts_.Get(key), nullptr);
+    DTEST_LOG << "PermissionVerdictCache002 end" << std::endl;
+}
+
 /**
  * @tc.name: CheckPermission002
  * @tc.desc: test CheckPermission002
@@ -698,13 +1032,16 @@ HWTEST_F(LocalAbilityManagerStubTest, SystemAbilityExtProc002, TestSize.Level2)
 
     std::string deviceId = "";
     MockSaRealize *sysAby = new MockSaRealize(MUT_SAID, false);
-    LocalAbilityManager::GetInstance().localAbilityMap_[MUT_SAID] = sysAby;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(MUT_SAID).ability = sysAby;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     LocalAbilityManager::GetInstance().NotifyAbilityListener(SAID, MUT_SAID, deviceId, STARTCODE);
-    LocalAbilityManager::GetInstance().localAbilityMap_[SAID] = sysAby;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(SAID).ability = sysAby;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     LocalAbilityManager::GetInstance().NotifyAbilityListener(SAID, MUT_SAID, deviceId, STARTCODE);
     int32_t ret = LocalAbilityManager::GetInstance().SystemAbilityExtProc(extension, SAID, &callback, isAsync);
     EXPECT_TRUE(ret == ERR_NONE);
-    LocalAbilityManager::GetInstance().localAbilityMap_.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     delete sysAby;
     DTEST_LOG << "SystemAbilityExtProc002 end" << std::endl;
 }
@@ -874,6 +1211,69 @@ HWTEST_F(LocalAbilityManagerStubTest, IpcStatCmdProcInner003, TestSize.Level2)
     DTEST_LOG << "IpcStatCmdProcInner003 end" << std::endl;
 }
 
+/**
+ * @tc.name: ListenerStatCmdProcInner001
+ * @tc.desc: test ListenerStatCmdProcInner without fd or cmd.
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerStubTest, ListenerStatCmdProcInner001, TestSize.Level2)
+{
+    DTEST_LOG << "ListenerStatCmdProcInner001 start" << std::endl;
+    MessageParcel data;
+    MessageParcel reply;
+    int32_t ret = LocalAbilityManager::GetInstance().ListenerStatCmdProcInner(data, reply);
+    EXPECT_EQ(ret, ERR_NULL_OBJECT);
+    MessageParcel fdData;
+    fdData.WriteFileDescriptor(1);
+    ret = LocalAbilityManager::GetInstance().ListenerStatCmdProcInner(fdData, reply);
+    EXPECT_EQ(ret, ERR_NULL_OBJECT);
+    EXPECT_NE(LocalAbilityManagerStub::GetStubHandler(
+        static_cast<uint32_t>(SafwkBinaryInterfaceCode::LISTENER_STAT_CMD_TRANSACTION)), nullptr);
+    DTEST_LOG << "ListenerStatCmdProcInner001 end" << std::endl;
+}
+
+/**
+ * @tc.name: LifecycleMetricsCmdProcInner001
+ * @tc.desc: test LifecycleMetricsCmdProcInner without fd or cmd.
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerStubTest, LifecycleMetricsCmdProcInner001, TestSize.Level2)
+{
+    DTEST_LOG << "LifecycleMetricsCmdProcInner001 start" << std::endl;
+    MessageParcel data;
+    MessageParcel reply;
+    int32_t ret = LocalAbilityManager::GetInstance().LifecycleMetricsCmdProcInner(data, reply);
+    EXPECT_EQ(ret, ERR_NULL_OBJECT);
+    MessageParcel fdData;
+    fdData.WriteFileDescriptor(1);
+    ret = LocalAbilityManager::GetInstance().LifecycleMetricsCmdProcInner(fdData, reply);
+    EXPECT_EQ(ret, ERR_NULL_OBJECT);
+    EXPECT_NE(LocalAbilityManagerStub::GetStubHandler(
+        static_cast<uint32_t>(SafwkBinaryInterfaceCode::LIFECYCLE_METRICS_CMD_TRANSACTION)), nullptr);
+    DTEST_LOG << "LifecycleMetricsCmdProcInner001 end" << std::endl;
+}
+
+/**
+ * @tc.name: SafwkTaskStatCmdProcInner001
+ * @tc.desc: test SafwkTaskStatCmdProcInner without fd or cmd.
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerStubTest, SafwkTaskStatCmdProcInner001, TestSize.Level2)
+{
+    DTEST_LOG << "SafwkTaskStatCmdProcInner001 start" << std::endl;
+    MessageParcel data;
+    MessageParcel reply;
+    int32_t ret = LocalAbilityManager::GetInstance().SafwkTaskStatCmdProcInner(data, reply);
+    EXPECT_EQ(ret, ERR_NULL_OBJECT);
+    MessageParcel fdData;
+    fdData.WriteFileDescriptor(1);
+    ret = LocalAbilityManager::GetInstance().SafwkTaskStatCmdProcInner(fdData, reply);
+    EXPECT_EQ(ret, ERR_NULL_OBJECT);
+    EXPECT_NE(LocalAbilityManagerStub::GetStubHandler(
+        static_cast<uint32_t>(SafwkBinaryInterfaceCode::SAFWK_TASK_STAT_CMD_TRANSACTION)), nullptr);
+    DTEST_LOG << "SafwkTaskStatCmdProcInner001 end" << std::endl;
+}
+
 /**
  * @tc.name: FfrtStatCmdProcInner001
  * @tc.desc: test FfrtStatCmdProcInner.
@@ -1138,10 +1538,12 @@ HWTEST_F(LocalAbilityManagerStubTest, ServiceControlCmdInner007, TestSize.Level2
     std::vector<std::u16string> u16args (1, Str8ToStr16(args));
     EXPECT_EQ(data.WriteString16Vector(u16args), true);
     MockSaRealize *sysAby = new MockSaRealize(SAID, false);
-    LocalAbilityManager::GetInstance().localAbilityMap_[SAID] = sysAby;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(SAID).ability = sysAby;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     int32_t ret = LocalAbilityManager::GetInstance().ServiceControlCmdInner(data, reply);
     EXPECT_NE(ret, ERR_NONE);
-    LocalAbilityManager::GetInstance().localAbilityMap_.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     delete sysAby;
     DTEST_LOG << "ServiceControlCmdInner007 end" << std::endl;
 }
@@ -1155,12 +1557,14 @@ HWTEST_F(LocalAbilityManagerStubTest, ServiceControlCmd001, TestSize.Level2)
 {
     DTEST_LOG << "ServiceControlCmd001 start" << std::endl;
     MockSaRealize *sysAby = new MockSaRealize(SAID, false);
-    LocalAbilityManager::GetInstance().localAbilityMap_[SAID] = sysAby;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(SAID).ability = sysAby;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     int32_t fd = 1;
     std::vector<std::u16string> args (1, Str8ToStr16(std::string("help")));
     int32_t ret = LocalAbilityManager::GetInstance().ServiceControlCmd(fd, SAID, args);
     EXPECT_NE(ret, ERR_NONE);
-    LocalAbilityManager::GetInstance().localAbilityMap_.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     delete sysAby;
     DTEST_LOG << "ServiceControlCmd001 end" << std::endl;
 }
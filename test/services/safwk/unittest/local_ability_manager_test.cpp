@@ -14,6 +14,10 @@
  */
 
 #include <fstream>
+#include <thread>
+#include "datetime_ex.h"
+#include "ffrt_handler.h"
+#include "ffrt_task_stats.h"
 #include "gtest/gtest.h"
 #include "iservice_registry.h"
 #include "string_ex.h"
@@ -23,6 +27,7 @@
 #define private public
 #include "local_ability_manager.h"
 #include "mock_sa_realize.h"
+#include "sa_metrics.h"
 #include "test_audio_ability.h"
 #undef private
 using namespace testing;
@@ -40,6 +45,8 @@ namespace {
     constexpr int STARTCODE = 1;
     constexpr uint32_t BOOTPHASE = 1;
     constexpr uint32_t OTHERPHASE = 3;
+    constexpr uint32_t COALESCE_MSECONDS = 1000;
+    constexpr const char* PREWARM_TASK = "SaPrewarm";
 }
 
 class LocalAbilityManagerTest : public testing::Test {
@@ -67,6 +74,13 @@ void LocalAbilityManagerTest::SetUp()
 
 void LocalAbilityManagerTest::TearDown()
 {
+    // a prewarm scheduled by a test must not fire into the next one
+    auto& manager = LocalAbilityManager::GetInstance();
+    std::lock_guard<std::mutex> autoLock(manager.prewarmLock_);
+    if (manager.prewarmPending_ && manager.prewarmHandler_ != nullptr) {
+        manager.prewarmHandler_->RemoveTask(PREWARM_TASK);
+    }
+    manager.prewarmPending_ = false;
     DTEST_LOG << "TearDown" << std::endl;
 }
 
@@ -79,14 +93,15 @@ HWTEST_F(LocalAbilityManagerTest, StartTimedQuery001, TestSize.Level1)
 {
     DTEST_LOG << "StartTimedQuery001 start" << std::endl;
     LocalAbilityManager::GetInstance().StartTimedQuery();
-    auto& saMap = LocalAbilityManager::GetInstance().localAbilityMap_;
     MockSaRealize *sysAby = new MockSaRealize(MUT_SAID, true);
-    saMap.emplace(MUT_SAID, sysAby);
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(MUT_SAID).ability = sysAby;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     auto ret = LocalAbilityManager::GetInstance().IsResident();
     LocalAbilityManager::GetInstance().StartTimedQuery();
     EXPECT_TRUE(ret);
     LocalAbilityManager::GetInstance().StopTimedQuery();
-    saMap.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     delete sysAby;
     DTEST_LOG << "StartTimedQuery001 end" << std::endl;
 }
@@ -99,18 +114,17 @@ HWTEST_F(LocalAbilityManagerTest, StartTimedQuery001, TestSize.Level1)
 HWTEST_F(LocalAbilityManagerTest, IdentifyUnusedOndemand001, TestSize.Level1)
 {
     DTEST_LOG << "IdentifyUnusedOndemand001 start" << std::endl;
-    auto& saMap = LocalAbilityManager::GetInstance().localAbilityMap_;
     MockSaRealize *sysAby = new MockSaRealize(MUT_SAID, false);
-    saMap.emplace(MUT_SAID, sysAby);
-    auto& unusedCfgMap = LocalAbilityManager::GetInstance().unusedCfgMap_;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(MUT_SAID).ability = sysAby;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     int32_t timeout = 1;
-    unusedCfgMap.emplace(MUT_SAID, timeout);
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(MUT_SAID).unusedTimeout = timeout;
     uint64_t lastRequestTime = 0;
     auto ret = LocalAbilityManager::GetInstance().GetSaLastRequestTime(MUT_SAID, lastRequestTime);
     LocalAbilityManager::GetInstance().IdentifyUnusedOndemand();
     EXPECT_FALSE(ret);
-    unusedCfgMap.clear();
-    saMap.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     delete sysAby;
     DTEST_LOG << "IdentifyUnusedOndemand001 end" << std::endl;
 }
@@ -123,20 +137,19 @@ HWTEST_F(LocalAbilityManagerTest, IdentifyUnusedOndemand001, TestSize.Level1)
 HWTEST_F(LocalAbilityManagerTest, IdentifyUnusedOndemand002, TestSize.Level1)
 {
     DTEST_LOG << "IdentifyUnusedOndemand002 start" << std::endl;
-    auto& saMap = LocalAbilityManager::GetInstance().localAbilityMap_;
     MockSaRealize *sysAby = new MockSaRealize(MUT_SAID, false);
-    saMap.emplace(MUT_SAID, sysAby);
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(MUT_SAID).ability = sysAby;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     sysAby->publishObj_ = sptr<IRemoteObject>(new TestAudioAbility(MUT_SAID, false));
-    auto& unusedCfgMap = LocalAbilityManager::GetInstance().unusedCfgMap_;
     int32_t timeout = 1;
-    unusedCfgMap.emplace(MUT_SAID, timeout);
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(MUT_SAID).unusedTimeout = timeout;
     uint64_t lastRequestTime = 0;
     auto ret = LocalAbilityManager::GetInstance().GetSaLastRequestTime(MUT_SAID, lastRequestTime);
     usleep(1500000);
     LocalAbilityManager::GetInstance().IdentifyUnusedOndemand();
     EXPECT_TRUE(ret);
-    unusedCfgMap.clear();
-    saMap.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     delete sysAby;
     DTEST_LOG << "IdentifyUnusedOndemand002 end" << std::endl;
 }
@@ -356,6 +369,36 @@ HWTEST_F(LocalAbilityManagerTest, CheckSystemAbilityManagerReady001, TestSize.Le
     DTEST_LOG << "CheckSystemAbilityManagerReady001 end" << std::endl;
 }
 
+/**
+ * @tc.name: CheckSystemAbilityManagerReady002
+ * @tc.desc:  CheckSystemAbilityManagerReady, return true when samgr is up!
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, CheckSystemAbilityManagerReady002, TestSize.Level3)
+{
+    DTEST_LOG << "CheckSystemAbilityManagerReady002 start" << std::endl;
+    if (SystemAbilityManagerClient::GetInstance().GetSystemAbilityManager() == nullptr) {
+        DTEST_LOG << "samgr is not available, skip" << std::endl;
+        return;
+    }
+    bool res = LocalAbilityManager::GetInstance().CheckSystemAbilityManagerReady();
+    EXPECT_TRUE(res);
+    DTEST_LOG << "CheckSystemAbilityManagerReady002 end" << std::endl;
+}
+
+/**
+ * @tc.name: WaitForSystemAbilityManager001
+ * @tc.desc:  WaitForSystemAbilityManager, expired deadline still returns samgr when it is up!
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, WaitForSystemAbilityManager001, TestSize.Level3)
+{
+    DTEST_LOG << "WaitForSystemAbilityManager001 start" << std::endl;
+    auto samgrProxy = LocalAbilityManager::GetInstance().WaitForSystemAbilityManager(GetTickCount());
+    EXPECT_NE(samgrProxy, nullptr);
+    DTEST_LOG << "WaitForSystemAbilityManager001 end" << std::endl;
+}
+
 /**
  * @tc.name: InitSystemAbilityProfiles001
  * @tc.desc:  InitSystemAbilityProfiles, ParseSaProfiles failed!
@@ -428,9 +471,11 @@ HWTEST_F(LocalAbilityManagerTest, AddAbility002, TestSize.Level3)
     bool ret = LocalAbilityManager::GetInstance().profileParser_->ParseSaProfiles
         (TEST_RESOURCE_PATH + "multi_sa_profile.json");
     EXPECT_TRUE(ret);
-    LocalAbilityManager::GetInstance().localAbilityMap_[MUT_SAID] = sysAby;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(MUT_SAID).ability = sysAby;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     bool res = LocalAbilityManager::GetInstance().AddAbility(sysAby);
-    LocalAbilityManager::GetInstance().localAbilityMap_.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     delete sysAby;
     EXPECT_FALSE(res);
     DTEST_LOG << "AddAbility002 end" << std::endl;
@@ -496,7 +541,7 @@ HWTEST_F(LocalAbilityManagerTest, AddSystemAbilityListener002, TestSize.Level1)
 HWTEST_F(LocalAbilityManagerTest, AddSystemAbilityListener003, TestSize.Level1)
 {
     DTEST_LOG << "AddSystemAbilityListener003 start" << std::endl;
-    LocalAbilityManager::GetInstance().localListenerMap_[SAID].push_back({MUT_SAID, ListenerState::INIT});
+    LocalAbilityManager::GetInstance().GetListenerRecordLocked(SAID).listeners.emplace(MUT_SAID, ListenerState::INIT);
     bool res = LocalAbilityManager::GetInstance().AddSystemAbilityListener(SAID, SAID);
     EXPECT_TRUE(res);
     DTEST_LOG << "AddSystemAbilityListener003 end" << std::endl;
@@ -510,8 +555,10 @@ HWTEST_F(LocalAbilityManagerTest, AddSystemAbilityListener003, TestSize.Level1)
 HWTEST_F(LocalAbilityManagerTest, AddSystemAbilityListener004, TestSize.Level1)
 {
     DTEST_LOG << "AddSystemAbilityListener004 start" << std::endl;
-    LocalAbilityManager::GetInstance().localListenerMap_[VAILD_SAID].push_back({VAILD_SAID, ListenerState::INIT});
-    LocalAbilityManager::GetInstance().localListenerMap_[VAILD_SAID].push_back({SAID, ListenerState::INIT});
+    LocalAbilityManager::GetInstance().GetListenerRecordLocked(VAILD_SAID).listeners.emplace(
+        VAILD_SAID, ListenerState::INIT);
+    LocalAbilityManager::GetInstance().GetListenerRecordLocked(VAILD_SAID).listeners.emplace(
+        SAID, ListenerState::INIT);
     sptr<ISystemAbilityManager> sm = SystemAbilityManagerClient::GetInstance().GetSystemAbilityManager();
     bool res = LocalAbilityManager::GetInstance().AddSystemAbilityListener(VAILD_SAID, VAILD_SAID);
     EXPECT_TRUE(res);
@@ -552,7 +599,7 @@ HWTEST_F(LocalAbilityManagerTest, RemoveSystemAbilityListener002, TestSize.Level
 HWTEST_F(LocalAbilityManagerTest, RemoveSystemAbilityListener003, TestSize.Level1)
 {
     DTEST_LOG << "RemoveSystemAbilityListener003 start" << std::endl;
-    LocalAbilityManager::GetInstance().localListenerMap_.clear();
+    LocalAbilityManager::GetInstance().listenerRecords_.clear();
     bool res = LocalAbilityManager::GetInstance().RemoveSystemAbilityListener(SAID, SAID);
     EXPECT_TRUE(res);
     DTEST_LOG << "RemoveSystemAbilityListener003 end" << std::endl;
@@ -566,15 +613,86 @@ HWTEST_F(LocalAbilityManagerTest, RemoveSystemAbilityListener003, TestSize.Level
 HWTEST_F(LocalAbilityManagerTest, RemoveSystemAbilityListener004, TestSize.Level3)
 {
     DTEST_LOG << "RemoveSystemAbilityListener004 start" << std::endl;
-    LocalAbilityManager::GetInstance().localListenerMap_[SAID].push_back({MUT_SAID, ListenerState::INIT});
+    LocalAbilityManager::GetInstance().GetListenerRecordLocked(SAID).listeners.emplace(MUT_SAID, ListenerState::INIT);
     bool res = LocalAbilityManager::GetInstance().RemoveSystemAbilityListener(SAID, SAID);
     EXPECT_TRUE(res);
     DTEST_LOG << "RemoveSystemAbilityListener004 end" << std::endl;
 }
 
+/**
+ * @tc.name: RemoveSystemAbilityListener005
+ * @tc.desc: test repeated add and remove of one listener keep a single entry per target SA
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, RemoveSystemAbilityListener005, TestSize.Level2)
+{
+    DTEST_LOG << "RemoveSystemAbilityListener005 start" << std::endl;
+    LocalAbilityManager::GetInstance().listenerRecords_.clear();
+    LocalAbilityManager::GetInstance().GetListenerRecordLocked(SAID).listeners.emplace(MUT_SAID, ListenerState::INIT);
+    EXPECT_TRUE(LocalAbilityManager::GetInstance().AddSystemAbilityListener(SAID, VAILD_SAID));
+    EXPECT_TRUE(LocalAbilityManager::GetInstance().AddSystemAbilityListener(SAID, VAILD_SAID));
+    auto listenerRecord = LocalAbilityManager::GetInstance().FindListenerRecordLocked(SAID);
+    ASSERT_NE(listenerRecord, nullptr);
+    EXPECT_EQ(listenerRecord->listeners.size(), 2);
+    EXPECT_EQ(listenerRecord->listeners.count(VAILD_SAID), 1);
+    EXPECT_TRUE(LocalAbilityManager::GetInstance().RemoveSystemAbilityListener(SAID, VAILD_SAID));
+    EXPECT_TRUE(LocalAbilityManager::GetInstance().RemoveSystemAbilityListener(SAID, VAILD_SAID));
+    listenerRecord = LocalAbilityManager::GetInstance().FindListenerRecordLocked(SAID);
+    ASSERT_NE(listenerRecord, nullptr);
+    EXPECT_EQ(listenerRecord->listeners.size(), 1);
+    EXPECT_EQ(listenerRecord->listeners.count(VAILD_SAID), 0);
+    LocalAbilityManager::GetInstance().listenerRecords_.clear();
+    DTEST_LOG << "RemoveSystemAbilityListener005 end" << std::endl;
+}
+
+/**
+ * @tc.name: SyncListenerSubscription001
+ * @tc.desc: test SyncListenerSubscription, a subscription whose last listener went away meanwhile is dropped
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, SyncListenerSubscription001, TestSize.Level2)
+{
+    DTEST_LOG << "SyncListenerSubscription001 start" << std::endl;
+    sptr<ISystemAbilityManager> samgrProxy = SystemAbilityManagerClient::GetInstance().GetSystemAbilityManager();
+    ASSERT_NE(samgrProxy, nullptr);
+    auto& manager = LocalAbilityManager::GetInstance();
+    manager.listenerRecords_.clear();
+    manager.subscribedSaIds_.clear();
+    EXPECT_TRUE(manager.AddSystemAbilityListener(SAID, MUT_SAID));
+    EXPECT_EQ(manager.subscribedSaIds_.count(SAID), 1);
+    manager.listenerRecords_.clear();
+    bool isSubscribed = false;
+    EXPECT_TRUE(manager.SyncListenerSubscription(samgrProxy, SAID, isSubscribed));
+    EXPECT_FALSE(isSubscribed);
+    EXPECT_EQ(manager.subscribedSaIds_.count(SAID), 0);
+    DTEST_LOG << "SyncListenerSubscription001 end" << std::endl;
+}
+
+/**
+ * @tc.name: CheckPresentAbilities001
+ * @tc.desc: test CheckPresentAbilities, one samgr listing finds the same SAs as checking each
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, CheckPresentAbilities001, TestSize.Level2)
+{
+    DTEST_LOG << "CheckPresentAbilities001 start" << std::endl;
+    sptr<ISystemAbilityManager> samgrProxy = SystemAbilityManagerClient::GetInstance().GetSystemAbilityManager();
+    ASSERT_NE(samgrProxy, nullptr);
+    std::vector<std::pair<int32_t, bool>> checkList = {{SAID, false}, {MUT_SAID, true}, {VAILD_SAID, false},
+        {INVALID_SAID, false}, {SAID + 1, true}};
+    std::vector<std::pair<int32_t, bool>> expected;
+    for (const auto& item : checkList) {
+        if (samgrProxy->CheckSystemAbility(item.first) != nullptr) {
+            expected.push_back(item);
+        }
+    }
+    EXPECT_EQ(LocalAbilityManager::GetInstance().CheckPresentAbilities(samgrProxy, checkList), expected);
+    DTEST_LOG << "CheckPresentAbilities001 end" << std::endl;
+}
+
 /**
  * @tc.name: FindAndNotifyAbilityListeners001
- * @tc.desc: test FindAndNotifyAbilityListeners with localListenerMap_ is empty
+ * @tc.desc: test FindAndNotifyAbilityListeners with listenerRecords_ is empty
  * @tc.type: FUNC
  * @tc.require: I7G7DL
  */
@@ -582,9 +700,172 @@ HWTEST_F(LocalAbilityManagerTest, FindAndNotifyAbilityListeners001, TestSize.Lev
 {
     int32_t code = 1;
     std::string deviceId = "";
-    LocalAbilityManager::GetInstance().localListenerMap_.clear();
+    LocalAbilityManager::GetInstance().listenerRecords_.clear();
     LocalAbilityManager::GetInstance().FindAndNotifyAbilityListeners(SAID, deviceId, code);
-    EXPECT_TRUE(LocalAbilityManager::GetInstance().localListenerMap_.empty());
+    EXPECT_TRUE(LocalAbilityManager::GetInstance().listenerRecords_.empty());
+}
+
+/**
+ * @tc.name: FindAndNotifyAbilityListeners002
+ * @tc.desc: test FindAndNotifyAbilityListeners posts to a serial queue per listener SA
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, FindAndNotifyAbilityListeners002, TestSize.Level2)
+{
+    DTEST_LOG << "FindAndNotifyAbilityListeners002 start" << std::endl;
+    std::string deviceId = "";
+    LocalAbilityManager::GetInstance().listenerRecords_.clear();
+    LocalAbilityManager::GetInstance().GetListenerRecordLocked(SAID).listeners.emplace(MUT_SAID, ListenerState::INIT);
+    LocalAbilityManager::GetInstance().FindAndNotifyAbilityListeners(SAID, deviceId,
+        ISystemAbilityStatusChange::ON_ADD_SYSTEM_ABILITY);
+    auto listenerRecord = LocalAbilityManager::GetInstance().FindListenerRecordLocked(SAID);
+    ASSERT_NE(listenerRecord, nullptr);
+    EXPECT_EQ(listenerRecord->listeners[MUT_SAID], ListenerState::NOTIFIED);
+    EXPECT_NE(LocalAbilityManager::GetInstance().listenerPool_, nullptr);
+    LocalAbilityManager::GetInstance().listenerRecords_.clear();
+    DTEST_LOG << "FindAndNotifyAbilityListeners002 end" << std::endl;
+}
+
+/**
+ * @tc.name: PostCoalescedEvent001
+ * @tc.desc: test a burst of add and remove events collapses to the latest net state
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, PostCoalescedEvent001, TestSize.Level2)
+{
+    DTEST_LOG << "PostCoalescedEvent001 start" << std::endl;
+    std::string deviceId = "";
+    auto& manager = LocalAbilityManager::GetInstance();
+    manager.coalesceCfgMap_[MUT_SAID] = COALESCE_MSECONDS;
+    manager.PostNotifyAbilityListener(SAID, MUT_SAID, deviceId, ISystemAbilityStatusChange::ON_ADD_SYSTEM_ABILITY);
+    manager.PostNotifyAbilityListener(SAID, MUT_SAID, deviceId, ISystemAbilityStatusChange::ON_REMOVE_SYSTEM_ABILITY);
+    manager.PostNotifyAbilityListener(SAID, MUT_SAID, deviceId, ISystemAbilityStatusChange::ON_ADD_SYSTEM_ABILITY);
+    uint64_t taskSeq = 0;
+    {
+        std::lock_guard<std::mutex> autoLock(manager.listenerHandlerLock_);
+        auto& event = manager.coalescedEvents_[{SAID, MUT_SAID}];
+        EXPECT_EQ(event.pendingCode, ISystemAbilityStatusChange::ON_ADD_SYSTEM_ABILITY);
+        EXPECT_EQ(event.deliveredCode, 0);
+        taskSeq = event.taskSeq;
+    }
+    manager.DeliverCoalescedEvent(SAID, MUT_SAID, 0, taskSeq);
+    manager.PostNotifyAbilityListener(SAID, MUT_SAID, deviceId, ISystemAbilityStatusChange::ON_REMOVE_SYSTEM_ABILITY);
+    manager.PostNotifyAbilityListener(SAID, MUT_SAID, deviceId, ISystemAbilityStatusChange::ON_ADD_SYSTEM_ABILITY);
+    {
+        std::lock_guard<std::mutex> autoLock(manager.listenerHandlerLock_);
+        taskSeq = manager.coalescedEvents_[{SAID, MUT_SAID}].taskSeq;
+    }
+    manager.DeliverCoalescedEvent(SAID, MUT_SAID, 0, taskSeq);
+    {
+        std::lock_guard<std::mutex> autoLock(manager.listenerHandlerLock_);
+        auto& event = manager.coalescedEvents_[{SAID, MUT_SAID}];
+        EXPECT_EQ(event.pendingCode, 0);
+        EXPECT_EQ(event.deliveredCode, ISystemAbilityStatusChange::ON_ADD_SYSTEM_ABILITY);
+    }
+    manager.ClearCoalescedEvent(SAID, MUT_SAID);
+    EXPECT_TRUE(manager.coalescedEvents_.empty());
+    manager.coalesceCfgMap_.clear();
+    DTEST_LOG << "PostCoalescedEvent001 end" << std::endl;
+}
+
+/**
+ * @tc.name: ReleaseListener001
+ * @tc.desc: test a removed listener SA drops its coalesced events and statistics, a stale task delivers no newer event
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, ReleaseListener001, TestSize.Level2)
+{
+    DTEST_LOG << "ReleaseListener001 start" << std::endl;
+    std::string deviceId = "";
+    auto& manager = LocalAbilityManager::GetInstance();
+    manager.GetListenerStat(MUT_SAID);
+    manager.coalesceCfgMap_[MUT_SAID] = COALESCE_MSECONDS;
+    manager.PostNotifyAbilityListener(SAID, MUT_SAID, deviceId, ISystemAbilityStatusChange::ON_ADD_SYSTEM_ABILITY);
+    uint64_t staleSeq = 0;
+    {
+        std::lock_guard<std::mutex> autoLock(manager.listenerHandlerLock_);
+        staleSeq = manager.coalescedEvents_[{SAID, MUT_SAID}].taskSeq;
+    }
+    EXPECT_TRUE(manager.RemoveAbility(MUT_SAID));
+    EXPECT_TRUE(manager.coalescedEvents_.empty());
+    EXPECT_EQ(manager.listenerStats_.count(MUT_SAID), 0);
+    manager.PostNotifyAbilityListener(SAID, MUT_SAID, deviceId, ISystemAbilityStatusChange::ON_ADD_SYSTEM_ABILITY);
+    manager.DeliverCoalescedEvent(SAID, MUT_SAID, 0, staleSeq);
+    {
+        std::lock_guard<std::mutex> autoLock(manager.listenerHandlerLock_);
+        auto& event = manager.coalescedEvents_[{SAID, MUT_SAID}];
+        EXPECT_EQ(event.pendingCode, ISystemAbilityStatusChange::ON_ADD_SYSTEM_ABILITY);
+        EXPECT_NE(event.taskSeq, staleSeq);
+    }
+    manager.ReleaseListener(MUT_SAID);
+    EXPECT_TRUE(manager.coalescedEvents_.empty());
+    manager.coalesceCfgMap_.clear();
+    DTEST_LOG << "ReleaseListener001 end" << std::endl;
+}
+
+/**
+ * @tc.name: ListenerStatCmdProc001
+ * @tc.desc: test listener dispatch statistics are recorded, dumped and reset
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, ListenerStatCmdProc001, TestSize.Level2)
+{
+    DTEST_LOG << "ListenerStatCmdProc001 start" << std::endl;
+    auto& manager = LocalAbilityManager::GetInstance();
+    manager.TimedNotifyAbilityListener(SAID, MUT_SAID, "", ISystemAbilityStatusChange::ON_ADD_SYSTEM_ABILITY, 0);
+    auto stat = manager.GetListenerStat(MUT_SAID);
+    EXPECT_EQ(stat->dispatch.GetSummary().count, 1);
+    EXPECT_EQ(stat->queueing.GetSummary().count, 1);
+    std::string result;
+    manager.DumpListenerStatistics(result);
+    EXPECT_NE(result.find("listenerSA:" + std::to_string(MUT_SAID)), std::string::npos);
+    EXPECT_FALSE(manager.ListenerStatCmdProc(-1, LISTENER_STAT_CMD_MAX));
+    manager.ListenerStatCmdProc(-1, LISTENER_STAT_CMD_RESET);
+    EXPECT_EQ(stat->dispatch.GetSummary().count, 0);
+    EXPECT_EQ(stat->slowCount.load(), 0);
+    DTEST_LOG << "ListenerStatCmdProc001 end" << std::endl;
+}
+
+/**
+ * @tc.name: LifecycleMetricsCmdProc001
+ * @tc.desc: test LifecycleMetricsCmdProc rejects invalid commands and resets the metrics
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, LifecycleMetricsCmdProc001, TestSize.Level2)
+{
+    DTEST_LOG << "LifecycleMetricsCmdProc001 start" << std::endl;
+    auto& manager = LocalAbilityManager::GetInstance();
+    SaMetrics::GetInstance().Record(SAID, SaPhase::ON_START, 1);
+    std::string result;
+    SaMetrics::GetInstance().Dump(result);
+    EXPECT_NE(result.find("SA:" + std::to_string(SAID) + " OnStart"), std::string::npos);
+    EXPECT_FALSE(manager.LifecycleMetricsCmdProc(-1, LIFECYCLE_METRICS_CMD_MAX));
+    manager.LifecycleMetricsCmdProc(-1, LIFECYCLE_METRICS_CMD_RESET);
+    result.clear();
+    SaMetrics::GetInstance().Dump(result);
+    EXPECT_EQ(result.find("SA:" + std::to_string(SAID) + " OnStart"), std::string::npos);
+    DTEST_LOG << "LifecycleMetricsCmdProc001 end" << std::endl;
+}
+
+/**
+ * @tc.name: SafwkTaskStatCmdProc001
+ * @tc.desc: test SafwkTaskStatCmdProc rejects invalid commands and resets the safwk task statistics
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, SafwkTaskStatCmdProc001, TestSize.Level2)
+{
+    DTEST_LOG << "SafwkTaskStatCmdProc001 start" << std::endl;
+    auto& manager = LocalAbilityManager::GetInstance();
+    FfrtTaskStats::GetInstance().Record("safwkTask", 0, 1);
+    std::string result;
+    FfrtTaskStats::GetInstance().Dump(result);
+    EXPECT_NE(result.find("safwkTask sum:1 count:1"), std::string::npos);
+    EXPECT_FALSE(manager.SafwkTaskStatCmdProc(-1, SAFWK_TASK_STAT_CMD_MAX));
+    manager.SafwkTaskStatCmdProc(-1, SAFWK_TASK_STAT_CMD_RESET);
+    result.clear();
+    FfrtTaskStats::GetInstance().Dump(result);
+    EXPECT_EQ(result.find("safwkTask sum:"), std::string::npos);
+    DTEST_LOG << "SafwkTaskStatCmdProc001 end" << std::endl;
 }
 
 /**
@@ -597,12 +878,15 @@ HWTEST_F(LocalAbilityManagerTest, OnStartAbility001, TestSize.Level1)
     DTEST_LOG << "OnStartAbility001 start" << std::endl;
     std::string deviceId = "";
     MockSaRealize *sysAby = new MockSaRealize(MUT_SAID, false);
-    LocalAbilityManager::GetInstance().localAbilityMap_[MUT_SAID] = sysAby;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(MUT_SAID).ability = sysAby;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     LocalAbilityManager::GetInstance().NotifyAbilityListener(SAID, MUT_SAID, deviceId, STARTCODE);
-    LocalAbilityManager::GetInstance().localAbilityMap_[SAID] = sysAby;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(SAID).ability = sysAby;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     LocalAbilityManager::GetInstance().NotifyAbilityListener(SAID, MUT_SAID, deviceId, STARTCODE);
     bool res = LocalAbilityManager::GetInstance().OnStartAbility(SAID);
-    LocalAbilityManager::GetInstance().localAbilityMap_.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     delete sysAby;
     EXPECT_TRUE(res);
     DTEST_LOG << "OnStartAbility001 end" << std::endl;
@@ -620,11 +904,14 @@ HWTEST_F(LocalAbilityManagerTest, OnStartAbility002, TestSize.Level1)
     int32_t removeAbility = 2;
     int32_t otherAbility = 3;
     MockSaRealize *sysAby = new MockSaRealize(MUT_SAID, false);
-    LocalAbilityManager::GetInstance().localAbilityMap_[MUT_SAID] = sysAby;
-    LocalAbilityManager::GetInstance().localAbilityMap_[SAID] = sysAby;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(MUT_SAID).ability = sysAby;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(SAID).ability = sysAby;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     LocalAbilityManager::GetInstance().NotifyAbilityListener(SAID, MUT_SAID, deviceId, removeAbility);
     LocalAbilityManager::GetInstance().NotifyAbilityListener(SAID, MUT_SAID, deviceId, otherAbility);
-    LocalAbilityManager::GetInstance().localAbilityMap_.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     bool res = LocalAbilityManager::GetInstance().OnStartAbility(SAID);
     EXPECT_FALSE(res);
     DTEST_LOG << "OnStartAbility002 end" << std::endl;
@@ -639,12 +926,77 @@ HWTEST_F(LocalAbilityManagerTest, GetAbility001, TestSize.Level1)
 {
     DTEST_LOG << "GetAbility001 start" << std::endl;
     std::string deviceId = "";
-    LocalAbilityManager::GetInstance().localAbilityMap_.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     SystemAbility* res = LocalAbilityManager::GetInstance().GetAbility(SAID);
     EXPECT_EQ(res, nullptr);
     DTEST_LOG << "GetAbility001 end" << std::endl;
 }
 
+/**
+ * @tc.name: PublishAbilityRegistryLocked001
+ * @tc.desc: PublishAbilityRegistryLocked, retired registry is kept while a reader pins it
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, PublishAbilityRegistryLocked001, TestSize.Level1)
+{
+    DTEST_LOG << "PublishAbilityRegistryLocked001 start" << std::endl;
+    auto& manager = LocalAbilityManager::GetInstance();
+    MockSaRealize *sysAby = new MockSaRealize(MUT_SAID, false);
+    manager.saRecords_.clear();
+    manager.PublishAbilityRegistryLocked();
+    EXPECT_TRUE(manager.retiredRegistries_.empty());
+    auto hazard = manager.ClaimRegistryHazard();
+    ASSERT_NE(hazard, nullptr);
+    hazard->registry = manager.abilityRegistry_.load();
+    manager.GetSaRecordLocked(MUT_SAID).ability = sysAby;
+    manager.PublishAbilityRegistryLocked();
+    EXPECT_EQ(manager.retiredRegistries_.size(), 1);
+    EXPECT_EQ(manager.abilityRegistry_.load()->abilities.size(), 1);
+    hazard->registry = nullptr;
+    EXPECT_EQ(manager.ClaimRegistryHazard(), hazard);
+    EXPECT_EQ(manager.GetAbility(MUT_SAID), sysAby);
+    manager.saRecords_.clear();
+    manager.PublishAbilityRegistryLocked();
+    EXPECT_TRUE(manager.retiredRegistries_.empty());
+    EXPECT_EQ(manager.GetAbility(MUT_SAID), nullptr);
+    delete sysAby;
+    DTEST_LOG << "PublishAbilityRegistryLocked001 end" << std::endl;
+}
+
+/**
+ * @tc.name: GetPhaseAbilities001
+ * @tc.desc: GetPhaseAbilities, records stay sorted and SAs start in profile order
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, GetPhaseAbilities001, TestSize.Level1)
+{
+    DTEST_LOG << "GetPhaseAbilities001 start" << std::endl;
+    auto& manager = LocalAbilityManager::GetInstance();
+    MockSaRealize *sysAby = new MockSaRealize(MUT_SAID, false);
+    MockSaRealize *otherAby = new MockSaRealize(SAID, false);
+    manager.saRecords_.clear();
+    manager.GetSaRecordLocked(SAID).ability = otherAby;
+    manager.GetSaRecordLocked(MUT_SAID).ability = sysAby;
+    EXPECT_EQ(manager.saRecords_.size(), 2);
+    EXPECT_TRUE(manager.saRecords_[0].saId < manager.saRecords_[1].saId);
+    SaProfile saProfile;
+    saProfile.bootPhase = OTHERPHASE;
+    saProfile.saId = MUT_SAID;
+    EXPECT_TRUE(manager.InitializeSaProfilesInnerLocked(saProfile));
+    saProfile.saId = SAID;
+    EXPECT_TRUE(manager.InitializeSaProfilesInnerLocked(saProfile));
+    auto systemAbilityList = manager.GetPhaseAbilities(OTHERPHASE);
+    ASSERT_EQ(systemAbilityList.size(), 2);
+    EXPECT_EQ(systemAbilityList.front(), sysAby);
+    EXPECT_EQ(systemAbilityList.back(), otherAby);
+    EXPECT_TRUE(manager.GetPhaseAbilities(BOOTPHASE).empty());
+    manager.saRecords_.clear();
+    delete sysAby;
+    delete otherAby;
+    DTEST_LOG << "GetPhaseAbilities001 end" << std::endl;
+}
+
 /**
  * @tc.name: GetAbility002
  * @tc.desc: GetAbility, SA not register
@@ -655,9 +1007,11 @@ HWTEST_F(LocalAbilityManagerTest, GetAbility002, TestSize.Level1)
     DTEST_LOG << "GetAbility002 start" << std::endl;
     std::string deviceId = "";
     MockSaRealize *sysAby = new MockSaRealize(SAID, false);
-    LocalAbilityManager::GetInstance().localAbilityMap_[SAID] = sysAby;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(SAID).ability = sysAby;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     SystemAbility* res = LocalAbilityManager::GetInstance().GetAbility(SAID);
-    LocalAbilityManager::GetInstance().localAbilityMap_.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     delete sysAby;
     EXPECT_NE(res, nullptr);
     DTEST_LOG << "GetAbility002 end" << std::endl;
@@ -673,7 +1027,7 @@ HWTEST_F(LocalAbilityManagerTest, GetRunningStatus001, TestSize.Level1)
     DTEST_LOG << "GetRunningStatus001 start" << std::endl;
     std::string deviceId = "";
     bool res = LocalAbilityManager::GetInstance().GetRunningStatus(SAID);
-    LocalAbilityManager::GetInstance().localListenerMap_.clear();
+    LocalAbilityManager::GetInstance().listenerRecords_.clear();
     EXPECT_FALSE(res);
     DTEST_LOG << "GetRunningStatus001 end" << std::endl;
 }
@@ -687,9 +1041,11 @@ HWTEST_F(LocalAbilityManagerTest, GetRunningStatus002, TestSize.Level1)
 {
     DTEST_LOG << "GetRunningStatus002 start" << std::endl;
     MockSaRealize *mockSa = new MockSaRealize(SAID, false);
-    LocalAbilityManager::GetInstance().localAbilityMap_[SAID] = mockSa;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(SAID).ability = mockSa;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     bool res = LocalAbilityManager::GetInstance().GetRunningStatus(SAID);
-    LocalAbilityManager::GetInstance().localAbilityMap_.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     delete mockSa;
     EXPECT_FALSE(res);
     DTEST_LOG << "GetRunningStatus002 end" << std::endl;
@@ -720,17 +1076,332 @@ HWTEST_F(LocalAbilityManagerTest, StartOndemandSystemAbility002, TestSize.Level1
 {
     DTEST_LOG << "StartOndemandSystemAbility002 start" << std::endl;
     std::string profilePath = "/system/usr/profile_audio.json";
-    LocalAbilityManager::GetInstance().localAbilityMap_.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     MockSaRealize *mockSa = new MockSaRealize(SAID, false);
     LocalAbilityManager::GetInstance().profileParser_->saProfiles_.clear();
     LocalAbilityManager::GetInstance().profileParser_->ParseSaProfiles(profilePath);
-    LocalAbilityManager::GetInstance().localAbilityMap_[SAID] = mockSa;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(SAID).ability = mockSa;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     LocalAbilityManager::GetInstance().StartOndemandSystemAbility(SAID);
     delete mockSa;
     EXPECT_EQ(LocalAbilityManager::GetInstance().profileParser_->saProfiles_.size(), 3);
     DTEST_LOG << "StartOndemandSystemAbility002 end" << std::endl;
 }
 
+/**
+ * @tc.name: WaitForAbilityAdded001
+ * @tc.desc: WaitForAbilityAdded wakes up when the SA is added through AddAbility
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, WaitForAbilityAdded001, TestSize.Level1)
+{
+    DTEST_LOG << "WaitForAbilityAdded001 start" << std::endl;
+    auto& manager = LocalAbilityManager::GetInstance();
+    manager.saRecords_.clear();
+    manager.PublishAbilityRegistryLocked();
+    EXPECT_TRUE(manager.profileParser_->ParseSaProfiles(TEST_RESOURCE_PATH + "multi_sa_profile.json"));
+    MockSaRealize *mockSa = new MockSaRealize(MUT_SAID, false);
+    bool added = false;
+    std::thread addThread([&manager, &added, mockSa] () {
+        usleep(50000);
+        added = manager.AddAbility(mockSa);
+    });
+    bool ret = manager.WaitForAbilityAdded(MUT_SAID);
+    addThread.join();
+    EXPECT_TRUE(ret);
+    EXPECT_TRUE(added);
+    auto record = manager.FindSaRecordLocked(MUT_SAID);
+    ASSERT_NE(record, nullptr);
+    EXPECT_EQ(record->ability, mockSa);
+    manager.saRecords_.clear();
+    manager.PublishAbilityRegistryLocked();
+    delete mockSa;
+    DTEST_LOG << "WaitForAbilityAdded001 end" << std::endl;
+}
+
+/**
+ * @tc.name: WaitForAbilityAdded002
+ * @tc.desc: WaitForAbilityAdded time out when the SA is never added
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, WaitForAbilityAdded002, TestSize.Level1)
+{
+    DTEST_LOG << "WaitForAbilityAdded002 start" << std::endl;
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
+    bool ret = LocalAbilityManager::GetInstance().WaitForAbilityAdded(SAID);
+    EXPECT_FALSE(ret);
+    DTEST_LOG << "WaitForAbilityAdded002 end" << std::endl;
+}
+
+/**
+ * @tc.name: InitSaExtraCfg001
+ * @tc.desc: InitSaExtraCfg, prewarm and priority class are recorded
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, InitSaExtraCfg001, TestSize.Level1)
+{
+    DTEST_LOG << "InitSaExtraCfg001 start" << std::endl;
+    LocalAbilityManager::GetInstance().prewarmCfgSet_.clear();
+    LocalAbilityManager::GetInstance().InitSaExtraCfg(TEST_RESOURCE_PATH + "prewarm_profile.json");
+    auto& prewarmCfgSet = LocalAbilityManager::GetInstance().prewarmCfgSet_;
+    EXPECT_EQ(prewarmCfgSet.size(), 2);
+    EXPECT_NE(prewarmCfgSet.find(1496), prewarmCfgSet.end());
+    EXPECT_EQ(prewarmCfgSet.find(1495), prewarmCfgSet.end());
+    prewarmCfgSet.clear();
+    auto& manager = LocalAbilityManager::GetInstance();
+    EXPECT_EQ(manager.GetPriorityClass(1496), SaPriorityClass::USER_VISIBLE);
+    EXPECT_EQ(manager.GetPriorityClass(1495), SaPriorityClass::BACKGROUND);
+    EXPECT_EQ(manager.GetPriorityClass(1499), SaPriorityClass::DEFAULT);
+    manager.priorityCfgMap_.clear();
+    EXPECT_EQ(manager.GetListenerCoalesceTime(1496), 50);
+    EXPECT_EQ(manager.GetListenerCoalesceTime(1495), 0);
+    EXPECT_EQ(manager.GetListenerCoalesceTime(1499), 0);
+    manager.coalesceCfgMap_.clear();
+    DTEST_LOG << "InitSaExtraCfg001 end" << std::endl;
+}
+
+/**
+ * @tc.name: InitSaExtraCfg002
+ * @tc.desc: InitSaExtraCfg, profile without prewarm config
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, InitSaExtraCfg002, TestSize.Level1)
+{
+    DTEST_LOG << "InitSaExtraCfg002 start" << std::endl;
+    LocalAbilityManager::GetInstance().prewarmCfgSet_.clear();
+    LocalAbilityManager::GetInstance().InitSaExtraCfg("/system/usr/profile_audio.json");
+    EXPECT_TRUE(LocalAbilityManager::GetInstance().prewarmCfgSet_.empty());
+    LocalAbilityManager::GetInstance().InitSaExtraCfg(TEST_RESOURCE_PATH + "not_exist.json");
+    EXPECT_TRUE(LocalAbilityManager::GetInstance().prewarmCfgSet_.empty());
+    DTEST_LOG << "InitSaExtraCfg002 end" << std::endl;
+}
+
+/**
+ * @tc.name: GetPrewarmCandidates001
+ * @tc.desc: GetPrewarmCandidates, skip run-on-create and loaded SAs, most requested first
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, GetPrewarmCandidates001, TestSize.Level1)
+{
+    DTEST_LOG << "GetPrewarmCandidates001 start" << std::endl;
+    std::string profilePath = TEST_RESOURCE_PATH + "prewarm_profile.json";
+    auto& manager = LocalAbilityManager::GetInstance();
+    manager.saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
+    manager.profileParser_->saProfiles_.clear();
+    manager.profileParser_->ParseSaProfiles(profilePath);
+    manager.prewarmCfgSet_ = {1499, 1496, 1495};
+    manager.startRequestCount_.clear();
+    manager.RecordStartRequest(1496);
+    std::vector<int32_t> candidates = manager.GetPrewarmCandidates();
+    ASSERT_EQ(candidates.size(), 2);
+    EXPECT_EQ(candidates[0], 1496);
+    EXPECT_EQ(candidates[1], 1495);
+    EXPECT_EQ(manager.prewarmCfgSet_.find(1499), manager.prewarmCfgSet_.end());
+    manager.prewarmCfgSet_.clear();
+    manager.startRequestCount_.clear();
+    manager.profileParser_->saProfiles_.clear();
+    DTEST_LOG << "GetPrewarmCandidates001 end" << std::endl;
+}
+
+/**
+ * @tc.name: PrewarmOndemandSystemAbilities001
+ * @tc.desc: PrewarmOndemandSystemAbilities, defer while on-demand start is in flight
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, PrewarmOndemandSystemAbilities001, TestSize.Level1)
+{
+    DTEST_LOG << "PrewarmOndemandSystemAbilities001 start" << std::endl;
+    auto& manager = LocalAbilityManager::GetInstance();
+    manager.prewarmCfgSet_ = {1496};
+    manager.ondemandTaskNum_ = 1;
+    manager.PrewarmOndemandSystemAbilities();
+    EXPECT_EQ(manager.prewarmCfgSet_.size(), 1);
+    EXPECT_TRUE(manager.prewarmPending_);
+    manager.ondemandTaskNum_ = 0;
+    {
+        std::lock_guard<std::mutex> autoLock(manager.prewarmLock_);
+        manager.prewarmCfgSet_.clear();
+    }
+    DTEST_LOG << "PrewarmOndemandSystemAbilities001 end" << std::endl;
+}
+
+/**
+ * @tc.name: StartAbility001
+ * @tc.desc: StartAbility, duplicated start requests are merged while the worker runs
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, StartAbility001, TestSize.Level1)
+{
+    DTEST_LOG << "StartAbility001 start" << std::endl;
+    auto& manager = LocalAbilityManager::GetInstance();
+    manager.ondemandTaskMap_[MUT_SAID].running = true;
+    EXPECT_TRUE(manager.StartAbility(MUT_SAID, "{\"eventId\":1}"));
+    EXPECT_TRUE(manager.StartAbility(MUT_SAID, "{\"eventId\":2}"));
+    auto& task = manager.ondemandTaskMap_[MUT_SAID];
+    EXPECT_TRUE(task.startPending);
+    EXPECT_FALSE(task.stopPending);
+    EXPECT_EQ(task.startReasons.size(), 2);
+    manager.ondemandTaskMap_.clear();
+    DTEST_LOG << "StartAbility001 end" << std::endl;
+}
+
+/**
+ * @tc.name: StopAbility001
+ * @tc.desc: StopAbility, a stop arriving while a start is pending cancels the start
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, StopAbility001, TestSize.Level1)
+{
+    DTEST_LOG << "StopAbility001 start" << std::endl;
+    auto& manager = LocalAbilityManager::GetInstance();
+    manager.ondemandTaskMap_[MUT_SAID].running = true;
+    EXPECT_TRUE(manager.StartAbility(MUT_SAID, "{\"eventId\":1}"));
+    EXPECT_TRUE(manager.StopAbility(MUT_SAID, "{\"eventId\":2}"));
+    auto& task = manager.ondemandTaskMap_[MUT_SAID];
+    EXPECT_FALSE(task.startPending);
+    EXPECT_TRUE(task.stopPending);
+    EXPECT_TRUE(task.startReasons.empty());
+    manager.ondemandTaskMap_.clear();
+    DTEST_LOG << "StopAbility001 end" << std::endl;
+}
+
+/**
+ * @tc.name: BatchLifecycle001
+ * @tc.desc: BatchLifecycle, entries are queued in order and each gets its own result
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, BatchLifecycle001, TestSize.Level1)
+{
+    DTEST_LOG << "BatchLifecycle001 start" << std::endl;
+    auto& manager = LocalAbilityManager::GetInstance();
+    manager.ondemandTaskMap_[MUT_SAID].running = true;
+    std::vector<SaLifecycleCommand> commands(3);
+    commands[0].saId = MUT_SAID;
+    commands[0].op = SaLifecycleOp::START;
+    commands[1].saId = MUT_SAID;
+    commands[1].op = SaLifecycleOp::STOP;
+    commands[2].saId = SAID;
+    commands[2].op = SaLifecycleOp::ACTIVE;
+    manager.BatchLifecycle(commands);
+    EXPECT_TRUE(commands[0].result);
+    EXPECT_TRUE(commands[1].result);
+    EXPECT_FALSE(commands[2].result);
+    auto& task = manager.ondemandTaskMap_[MUT_SAID];
+    EXPECT_FALSE(task.startPending);
+    EXPECT_TRUE(task.stopPending);
+    manager.ondemandTaskMap_.clear();
+    DTEST_LOG << "BatchLifecycle001 end" << std::endl;
+}
+
+/**
+ * @tc.name: StartBatchGroup001
+ * @tc.desc: StartBatchGroup, an SA whose start was cancelled within the batch gets no worker
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, StartBatchGroup001, TestSize.Level1)
+{
+    DTEST_LOG << "StartBatchGroup001 start" << std::endl;
+    auto& manager = LocalAbilityManager::GetInstance();
+    manager.ondemandTaskMap_[MUT_SAID].startPending = false;
+    manager.StartBatchGroup({MUT_SAID});
+    EXPECT_FALSE(manager.ondemandTaskMap_[MUT_SAID].running);
+    manager.ondemandTaskMap_.clear();
+    DTEST_LOG << "StartBatchGroup001 end" << std::endl;
+}
+
+/**
+ * @tc.name: ProcessOndemandTask001
+ * @tc.desc: ProcessOndemandTask, merged start reasons are all delivered
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, ProcessOndemandTask001, TestSize.Level1)
+{
+    DTEST_LOG << "ProcessOndemandTask001 start" << std::endl;
+    auto& manager = LocalAbilityManager::GetInstance();
+    auto& task = manager.ondemandTaskMap_[MUT_SAID];
+    task.running = true;
+    task.startPending = true;
+    task.startReasons.emplace_back(OnDemandReasonId::DEVICE_ONLINE, "", "", -1);
+    task.startReasons.emplace_back(OnDemandReasonId::SETTING_SWITCH, "", "", -1);
+    manager.ondemandTaskNum_++;
+    manager.ProcessOndemandTask(MUT_SAID);
+    EXPECT_TRUE(manager.ondemandTaskMap_.find(MUT_SAID) == manager.ondemandTaskMap_.end());
+    EXPECT_EQ(manager.ondemandTaskNum_, 0);
+    std::vector<SystemAbilityOnDemandReason> reasons = manager.GetMergedStartReasons(MUT_SAID);
+    ASSERT_EQ(reasons.size(), 2);
+    EXPECT_EQ(manager.GetStartReason(MUT_SAID).GetId(), OnDemandReasonId::SETTING_SWITCH);
+    manager.SetStartReason(MUT_SAID, std::move(reasons[0]));
+    EXPECT_EQ(manager.GetMergedStartReasons(MUT_SAID).size(), 1);
+    DTEST_LOG << "ProcessOndemandTask001 end" << std::endl;
+}
+
+/**
+ * @tc.name: UpdateUserVisibleTaskNum001
+ * @tc.desc: UpdateUserVisibleTaskNum, merged user-visible starts count once and a cancelled one is released
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, UpdateUserVisibleTaskNum001, TestSize.Level1)
+{
+    DTEST_LOG << "UpdateUserVisibleTaskNum001 start" << std::endl;
+    auto& manager = LocalAbilityManager::GetInstance();
+    manager.userVisibleTaskNum_ = 0;
+    manager.priorityCfgMap_[MUT_SAID] = SaPriorityClass::USER_VISIBLE;
+    manager.ondemandTaskMap_[MUT_SAID].running = true;
+    manager.StartAbility(MUT_SAID, "{\"eventId\":1}");
+    manager.StartAbility(MUT_SAID, "{\"eventId\":2}");
+    EXPECT_EQ(manager.userVisibleTaskNum_, 1);
+    manager.StopAbility(MUT_SAID, "{\"eventId\":3}");
+    EXPECT_EQ(manager.userVisibleTaskNum_, 0);
+    manager.ondemandTaskMap_.clear();
+    manager.priorityCfgMap_.clear();
+    DTEST_LOG << "UpdateUserVisibleTaskNum001 end" << std::endl;
+}
+
+/**
+ * @tc.name: YieldToUserVisibleTask001
+ * @tc.desc: YieldToUserVisibleTask, background start waits until user-visible starts finish
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, YieldToUserVisibleTask001, TestSize.Level1)
+{
+    DTEST_LOG << "YieldToUserVisibleTask001 start" << std::endl;
+    auto& manager = LocalAbilityManager::GetInstance();
+    manager.priorityCfgMap_[MUT_SAID] = SaPriorityClass::BACKGROUND;
+    manager.userVisibleTaskNum_ = 1;
+    std::atomic<bool> finished = false;
+    std::thread finishThread([&manager, &finished] () {
+        usleep(50000);
+        finished = true;
+        manager.UpdateUserVisibleTaskNum(false);
+    });
+    manager.YieldToUserVisibleTask(MUT_SAID);
+    EXPECT_TRUE(finished);
+    finishThread.join();
+    EXPECT_EQ(manager.userVisibleTaskNum_, 0);
+    manager.priorityCfgMap_.clear();
+    DTEST_LOG << "YieldToUserVisibleTask001 end" << std::endl;
+}
+
+/**
+ * @tc.name: YieldToUserVisibleTask002
+ * @tc.desc: YieldToUserVisibleTask, default class returns while user-visible starts are pending
+ * @tc.type: FUNC
+ */
+HWTEST_F(LocalAbilityManagerTest, YieldToUserVisibleTask002, TestSize.Level1)
+{
+    DTEST_LOG << "YieldToUserVisibleTask002 start" << std::endl;
+    auto& manager = LocalAbilityManager::GetInstance();
+    manager.priorityCfgMap_.clear();
+    manager.userVisibleTaskNum_ = 1;
+    manager.YieldToUserVisibleTask(MUT_SAID);
+    EXPECT_EQ(manager.userVisibleTaskNum_, 1);
+    manager.userVisibleTaskNum_ = 0;
+    DTEST_LOG << "YieldToUserVisibleTask002 end" << std::endl;
+}
+
 /**
  * @tc.name: InitializeSaProfiles001
  * @tc.desc: InitializeSaProfiles, sa profile is empty
@@ -753,7 +1424,8 @@ HWTEST_F(LocalAbilityManagerTest, InitializeSaProfiles001, TestSize.Level1)
 HWTEST_F(LocalAbilityManagerTest, InitializeSaProfiles002, TestSize.Level1)
 {
     DTEST_LOG << "InitializeSaProfiles002 start" << std::endl;
-    LocalAbilityManager::GetInstance().localAbilityMap_.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     bool res = LocalAbilityManager::GetInstance().InitializeSaProfiles(SAID);
     EXPECT_FALSE(res);
     DTEST_LOG << "InitializeSaProfiles002 end" << std::endl;
@@ -798,7 +1470,8 @@ HWTEST_F(LocalAbilityManagerTest, InitializeRunOnCreateSaProfiles003, TestSize.L
     DTEST_LOG << "InitializeRunOnCreateSaProfiles003 start" << std::endl;
     std::string profilePath = "/system/usr/profile_audio.json";
     MockSaRealize *mockSa = new MockSaRealize(SAID, false);
-    LocalAbilityManager::GetInstance().localAbilityMap_[SAID] = mockSa;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(SAID).ability = mockSa;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     LocalAbilityManager::GetInstance().profileParser_->ParseSaProfiles(profilePath);
     bool res = LocalAbilityManager::GetInstance().InitializeRunOnCreateSaProfiles(OTHERPHASE);
     delete mockSa;
@@ -815,7 +1488,8 @@ HWTEST_F(LocalAbilityManagerTest, InitializeOnDemandSaProfile001, TestSize.Level
 {
     DTEST_LOG << "InitializeOnDemandSaProfile001 start" << std::endl;
     std::string profilePath = "/system/usr/profile_audio.json";
-    LocalAbilityManager::GetInstance().localAbilityMap_.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     LocalAbilityManager::GetInstance().profileParser_->ParseSaProfiles(profilePath);
     bool res = LocalAbilityManager::GetInstance().InitializeOnDemandSaProfile(SAID);
     EXPECT_FALSE(res);
@@ -846,7 +1520,8 @@ HWTEST_F(LocalAbilityManagerTest, InitializeSaProfilesInnerLocked001, TestSize.L
     DTEST_LOG << "InitializeSaProfilesInnerLocked001 start" << std::endl;
     SaProfile saProfile;
     saProfile.saId = SAID;
-    LocalAbilityManager::GetInstance().localAbilityMap_.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     bool res = LocalAbilityManager::GetInstance().InitializeSaProfilesInnerLocked(saProfile);
     EXPECT_FALSE(res);
     DTEST_LOG << "InitializeSaProfilesInnerLocked001 end" << std::endl;
@@ -862,7 +1537,8 @@ HWTEST_F(LocalAbilityManagerTest, InitializeSaProfilesInnerLocked002, TestSize.L
     DTEST_LOG << "InitializeSaProfilesInnerLocked002 start" << std::endl;
     SaProfile saProfile;
     saProfile.saId = SAID;
-    LocalAbilityManager::GetInstance().localAbilityMap_[SAID] = nullptr;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(SAID).ability = nullptr;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     bool res = LocalAbilityManager::GetInstance().InitializeSaProfilesInnerLocked(saProfile);
     EXPECT_FALSE(res);
     DTEST_LOG << "InitializeSaProfilesInnerLocked002 end" << std::endl;
@@ -879,9 +1555,11 @@ HWTEST_F(LocalAbilityManagerTest, InitializeSaProfilesInnerLocked003, TestSize.L
     SaProfile saProfile;
     saProfile.saId = SAID;
     MockSaRealize *mockSa = new MockSaRealize(SAID, false);
-    LocalAbilityManager::GetInstance().localAbilityMap_[SAID] = mockSa;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(SAID).ability = mockSa;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     bool res = LocalAbilityManager::GetInstance().InitializeSaProfilesInnerLocked(saProfile);
-    LocalAbilityManager::GetInstance().localAbilityMap_.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     delete mockSa;
     EXPECT_TRUE(res);
     DTEST_LOG << "InitializeSaProfilesInnerLocked003 end" << std::endl;
@@ -899,9 +1577,11 @@ HWTEST_F(LocalAbilityManagerTest, InitializeSaProfilesInnerLocked004, TestSize.L
     saProfile.saId = SAID;
     saProfile.bootPhase = BOOTPHASE;
     MockSaRealize *mockSa = new MockSaRealize(SAID, false);
-    LocalAbilityManager::GetInstance().localAbilityMap_[SAID] = mockSa;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(SAID).ability = mockSa;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     bool res = LocalAbilityManager::GetInstance().InitializeSaProfilesInnerLocked(saProfile);
-    LocalAbilityManager::GetInstance().localAbilityMap_.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     delete mockSa;
     EXPECT_TRUE(res);
     DTEST_LOG << "InitializeSaProfilesInnerLocked004 end" << std::endl;
@@ -919,9 +1599,11 @@ HWTEST_F(LocalAbilityManagerTest, InitializeSaProfilesInnerLocked005, TestSize.L
     saProfile.saId = SAID;
     saProfile.bootPhase = BOOTPHASE;
     MockSaRealize *mockSa = new MockSaRealize(SAID, false);
-    LocalAbilityManager::GetInstance().localAbilityMap_[SAID] = mockSa;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(SAID).ability = mockSa;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     bool res = LocalAbilityManager::GetInstance().InitializeSaProfilesInnerLocked(saProfile);
-    LocalAbilityManager::GetInstance().localAbilityMap_.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     delete mockSa;
     EXPECT_TRUE(res);
     DTEST_LOG << "InitializeSaProfilesInnerLocked005 end" << std::endl;
@@ -1084,7 +1766,7 @@ HWTEST_F(LocalAbilityManagerTest, AddLocalAbilityManager001, TestSize.Level3)
 HWTEST_F(LocalAbilityManagerTest, AddLocalAbilityManager002, TestSize.Level3)
 {
     DTEST_LOG << "AddLocalAbilityManager002 start" << std::endl;
-    LocalAbilityManager::GetInstance().abilityPhaseMap_.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
     LocalAbilityManager::GetInstance().FindAndStartPhaseTasks(INVALID_SAID);
     LocalAbilityManager::GetInstance().procName_ = u"test";
     bool res = LocalAbilityManager::GetInstance().AddLocalAbilityManager();
@@ -1142,11 +1824,13 @@ HWTEST_F(LocalAbilityManagerTest, IsResident001, TestSize.Level1)
 {
     DTEST_LOG << "IsResident001 start" << std::endl;
     MockSaRealize *mockSa = new MockSaRealize(VAILD_SAID, true);
-    LocalAbilityManager::GetInstance().localAbilityMap_[VAILD_SAID] = mockSa;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(VAILD_SAID).ability = mockSa;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     auto ret = LocalAbilityManager::GetInstance().IsResident();
     delete mockSa;
     EXPECT_EQ(ret, true);
-    LocalAbilityManager::GetInstance().localAbilityMap_.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     DTEST_LOG << "IsResident001 end" << std::endl;
 }
 
@@ -1159,11 +1843,13 @@ HWTEST_F(LocalAbilityManagerTest, IsResident002, TestSize.Level1)
 {
     DTEST_LOG << "IsResident002 start" << std::endl;
     MockSaRealize *sysAby = new MockSaRealize(MUT_SAID, false);
-    LocalAbilityManager::GetInstance().localAbilityMap_[MUT_SAID] = sysAby;
+    LocalAbilityManager::GetInstance().GetSaRecordLocked(MUT_SAID).ability = sysAby;
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     auto ret = LocalAbilityManager::GetInstance().IsResident();
     delete sysAby;
     EXPECT_EQ(ret, false);
-    LocalAbilityManager::GetInstance().localAbilityMap_.clear();
+    LocalAbilityManager::GetInstance().saRecords_.clear();
+    LocalAbilityManager::GetInstance().PublishAbilityRegistryLocked();
     DTEST_LOG << "IsResident002 end" << std::endl;
 }
 
@@ -1212,7 +1898,8 @@ HWTEST_F(LocalAbilityManagerTest, InitUnusedCfg001, TestSize.Level1)
     saProfileList.push_back(saInfo5);
 
     LocalAbilityManager::GetInstance().InitUnusedCfg();
-    auto& unUsedCfgMap = LocalAbilityManager::GetInstance().unusedCfgMap_;
+    auto unusedCfgs = LocalAbilityManager::GetInstance().GetUnusedCfgs();
+    std::map<int32_t, int32_t> unUsedCfgMap(unusedCfgs.begin(), unusedCfgs.end());
     EXPECT_EQ(unUsedCfgMap.count(saInfo1.saId), 1);
     EXPECT_EQ(unUsedCfgMap[saInfo1.saId], timeoutUpLimit * 1000);
 
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sa_metrics.h"
+#include "test_log.h"
+
+using namespace testing;
+using namespace testing::ext;
+
+namespace OHOS {
+namespace {
+    // small enough to keep its slot whichever test fills the table first
+    constexpr int32_t SAID = 1;
+    constexpr int32_t THREAD_NUM = 4;
+    constexpr int32_t RECORD_NUM = 1000;
+}
+
+class SaMetricsTest : public testing::Test {
+public:
+    static void SetUpTestCase();
+    static void TearDownTestCase();
+    void SetUp();
+    void TearDown();
+};
+
+void SaMetricsTest::SetUpTestCase()
+{
+    DTEST_LOG << "SetUpTestCase" << std::endl;
+}
+
+void SaMetricsTest::TearDownTestCase()
+{
+    DTEST_LOG << "TearDownTestCase" << std::endl;
+}
+
+void SaMetricsTest::SetUp()
+{
+    SaMetrics::GetInstance().Reset();
+    DTEST_LOG << "SetUp" << std::endl;
+}
+
+void SaMetricsTest::TearDown()
+{
+    DTEST_LOG << "TearDown" << std::endl;
+}
+
+/**
+ * @tc.name: Record001
+ * @tc.desc: test concurrent records of one SA land in its phase histogram
+ * @tc.type: FUNC
+ */
+HWTEST_F(SaMetricsTest, Record001, TestSize.Level2)
+{
+    DTEST_LOG << "Record001 start" << std::endl;
+    std::vector<std::thread> threads;
+    for (int32_t i = 0; i < THREAD_NUM; ++i) {
+        threads.emplace_back([] {
+            for (int32_t j = 0; j < RECORD_NUM; ++j) {
+                SaMetrics::GetInstance().Record(SAID, SaPhase::ON_START, j);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    {
+        SaMetrics::ScopedTimer timer(SAID, SaPhase::LOAD_LIB);
+    }
+    SaMetrics::GetInstance().Record(SAID, SaPhase::PHASE_NUM, 1);
+    SaMetrics::GetInstance().Record(0, SaPhase::ON_STOP, 1);
+    std::string result;
+    SaMetrics::GetInstance().Dump(result);
+    EXPECT_NE(result.find("SA:1 OnStart count:4000"), std::string::npos);
+    EXPECT_NE(result.find("SA:1 LoadSaLib count:1"), std::string::npos);
+    EXPECT_EQ(result.find("OnStop"), std::string::npos);
+    SaMetrics::GetInstance().Reset();
+    result.clear();
+    SaMetrics::GetInstance().Dump(result);
+    EXPECT_EQ(result.find("SA:1 "), std::string::npos);
+    DTEST_LOG << "Record001 end" << std::endl;
+}
+
+/**
+ * @tc.name: Record002
+ * @tc.desc: test SAs beyond the table size are dropped without affecting recorded ones
+ * @tc.type: FUNC
+ */
+HWTEST_F(SaMetricsTest, Record002, TestSize.Level2)
+{
+    DTEST_LOG << "Record002 start" << std::endl;
+    for (int32_t saId = 1; saId <= static_cast<int32_t>(SaMetrics::MAX_SA_NUM) + 1; ++saId) {
+        SaMetrics::GetInstance().Record(saId, SaPhase::PUBLISH, saId);
+    }
+    std::string result;
+    SaMetrics::GetInstance().Dump(result);
+    EXPECT_NE(result.find("SA:1 Publish count:1"), std::string::npos);
+    EXPECT_EQ(result.find("SA:" + std::to_string(SaMetrics::MAX_SA_NUM + 1) + " "), std::string::npos);
+    DTEST_LOG << "Record002 end" << std::endl;
+}
+}
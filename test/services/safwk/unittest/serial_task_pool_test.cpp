@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2026 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "ffrt_task_stats.h"
+#include "gtest/gtest.h"
+#include "serial_task_pool.h"
+#include "test_log.h"
+
+using namespace testing;
+using namespace testing::ext;
+
+namespace OHOS {
+namespace {
+    constexpr int32_t WAIT_SECONDS = 2;
+    constexpr int32_t TASK_NUM = 100;
+    constexpr int32_t QUEUE_NUM = 4;
+    constexpr uint32_t THREAD_NUM = 2;
+    constexpr uint64_t DELAY_MS = 50;
+}
+
+class SerialTaskPoolTest : public testing::Test {
+public:
+    static void SetUpTestCase();
+    static void TearDownTestCase();
+    void SetUp();
+    void TearDown();
+};
+
+void SerialTaskPoolTest::SetUpTestCase()
+{
+    DTEST_LOG << "SetUpTestCase" << std::endl;
+}
+
+void SerialTaskPoolTest::TearDownTestCase()
+{
+    DTEST_LOG << "TearDownTestCase" << std::endl;
+}
+
+void SerialTaskPoolTest::SetUp()
+{
+    DTEST_LOG << "SetUp" << std::endl;
+}
+
+void SerialTaskPoolTest::TearDown()
+{
+    DTEST_LOG << "TearDown" << std::endl;
+}
+
+/**
+ * @tc.name: PostTask001
+ * @tc.desc: test the tasks of each queue run in the order they were posted
+ * @tc.type: FUNC
+ */
+HWTEST_F(SerialTaskPoolTest, PostTask001, TestSize.Level2)
+{
+    DTEST_LOG << "PostTask001 start" << std::endl;
+    std::vector<std::vector<int32_t>> orders(QUEUE_NUM);
+    std::promise<void> allDone;
+    std::future<void> allDoneFuture = allDone.get_future();
+    std::atomic<int32_t> doneNum = 0;
+    {
+        SerialTaskPool pool("SerialTaskTest", THREAD_NUM);
+        for (int32_t i = 0; i < TASK_NUM; ++i) {
+            int32_t queueId = i % QUEUE_NUM;
+            pool.PostTask(queueId, [&orders, &allDone, &doneNum, queueId, i] {
+                orders[queueId].push_back(i);
+                if (++doneNum == TASK_NUM) {
+                    allDone.set_value();
+                }
+            }, "task", 0);
+        }
+        EXPECT_EQ(allDoneFuture.wait_for(std::chrono::seconds(WAIT_SECONDS)), std::future_status::ready);
+    }
+    for (const auto& order : orders) {
+        EXPECT_TRUE(std::is_sorted(order.begin(), order.end()));
+    }
+    DTEST_LOG << "PostTask001 end" << std::endl;
+}
+
+/**
+ * @tc.name: PostTask002
+ * @tc.desc: test a queue posted to an idle pool right after a blocking one still runs on another thread
+ * @tc.type: FUNC
+ */
+HWTEST_F(SerialTaskPoolTest, PostTask002, TestSize.Level2)
+{
+    DTEST_LOG << "PostTask002 start" << std::endl;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::promise<void> otherDone;
+    std::future<void> otherDoneFuture = otherDone.get_future();
+    std::promise<void> firstDone;
+    std::future<void> firstDoneFuture = firstDone.get_future();
+    SerialTaskPool pool("SerialTaskTest", THREAD_NUM);
+    pool.PostTask(0, [&firstDone] { firstDone.set_value(); }, "first", 0);
+    EXPECT_EQ(firstDoneFuture.wait_for(std::chrono::seconds(WAIT_SECONDS)), std::future_status::ready);
+    // lets the only started thread go idle before the next two queues are posted
+    std::this_thread::sleep_for(std::chrono::milliseconds(DELAY_MS));
+    pool.PostTask(0, [released] { released.wait(); }, "block", 0);
+    pool.PostTask(1, [&otherDone] { otherDone.set_value(); }, "other", 0);
+    EXPECT_EQ(otherDoneFuture.wait_for(std::chrono::seconds(WAIT_SECONDS)), std::future_status::ready);
+    release.set_value();
+    DTEST_LOG << "PostTask002 end" << std::endl;
+}
+
+/**
+ * @tc.name: RemoveTask001
+ * @tc.desc: test a removed delayed task never runs while the other one of its queue does
+ * @tc.type: FUNC
+ */
+HWTEST_F(SerialTaskPoolTest, RemoveTask001, TestSize.Level2)
+{
+    DTEST_LOG << "RemoveTask001 start" << std::endl;
+    std::atomic<bool> removedRun = false;
+    std::promise<void> keptDone;
+    std::future<void> keptDoneFuture = keptDone.get_future();
+    SerialTaskPool pool("SerialTaskTest", THREAD_NUM);
+    pool.PostTask(0, [&removedRun] { removedRun = true; }, "removed", DELAY_MS);
+    pool.PostTask(0, [&keptDone] { keptDone.set_value(); }, "kept", DELAY_MS);
+    pool.RemoveTask(0, "removed");
+    EXPECT_EQ(keptDoneFuture.wait_for(std::chrono::seconds(WAIT_SECONDS)), std::future_status::ready);
+    EXPECT_FALSE(removedRun.load());
+    pool.PostTask(1, [&removedRun] { removedRun = true; }, "queued", DELAY_MS);
+    pool.RemoveQueue(1);
+    EXPECT_FALSE(removedRun.load());
+    DTEST_LOG << "RemoveTask001 end" << std::endl;
+}
+
+/**
+ * @tc.name: PostTask003
+ * @tc.desc: test tasks posted under distinct names share the statistics entry of their stat name
+ * @tc.type: FUNC
+ */
+HWTEST_F(SerialTaskPoolTest, PostTask003, TestSize.Level2)
+{
+    DTEST_LOG << "PostTask003 start" << std::endl;
+    FfrtTaskStats::GetInstance().Reset();
+    {
+        SerialTaskPool pool("SerialTaskTest", THREAD_NUM);
+        pool.PostTask(0, [] {}, "target1", 0, "sharedStat");
+        pool.PostTask(0, [] {}, "target2", 0, "sharedStat");
+        std::promise<void> done;
+        std::future<void> doneFuture = done.get_future();
+        pool.PostTask(0, [&done] { done.set_value(); }, "last", 0);
+        EXPECT_EQ(doneFuture.wait_for(std::chrono::seconds(WAIT_SECONDS)), std::future_status::ready);
+    }
+    std::string result;
+    FfrtTaskStats::GetInstance().Dump(result);
+    size_t pos = result.find("sharedStat sum:");
+    ASSERT_NE(pos, std::string::npos);
+    EXPECT_NE(result.substr(pos, result.find('\n', pos) - pos).find(" count:2"), std::string::npos);
+    EXPECT_EQ(result.find("target1 sum:"), std::string::npos);
+    DTEST_LOG << "PostTask003 end" << std::endl;
+}
+} // namespace OHOS
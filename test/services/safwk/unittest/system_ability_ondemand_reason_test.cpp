@@ -101,8 +101,8 @@ HWTEST_F(SystemAbilityOndemandReasonTest, OnDemandReasonExtraDataGetCode001, Tes
 HWTEST_F(SystemAbilityOndemandReasonTest, OnDemandReasonExtraDataGetWant001, TestSize.Level2)
 {
     DTEST_LOG << "OnDemandReasonExtraDataGetWant001 start" << std::endl;
-    OnDemandReasonExtraData onDemandReasonExtraData;
-    onDemandReasonExtraData.want_["test"] = "test";
+    std::map<std::string, std::string> want = {{"test", "test"}};
+    OnDemandReasonExtraData onDemandReasonExtraData(CODE, DATA, want);
     map testwant = onDemandReasonExtraData.GetWant();
     EXPECT_FALSE(testwant.empty());
     DTEST_LOG << "OnDemandReasonExtraDataGetWant001 end" << std::endl;
@@ -295,4 +295,175 @@ HWTEST_F(SystemAbilityOndemandReasonTest, SystemAbilityOnDemandReason001, TestSi
     EXPECT_EQ(reason.extraDataId_, extraDataId);
     DTEST_LOG << "SystemAbilityOnDemandReason001 end" << std::endl;
 }
-}
\ No newline at end of file
+
+/**
+ * @tc.name: SystemAbilityOnDemandReasonMarshalling001
+ * @tc.desc: test Marshalling and Unmarshalling of SystemAbilityOnDemandReason
+ * @tc.type: FUNC
+ */
+HWTEST_F(SystemAbilityOndemandReasonTest, SystemAbilityOnDemandReasonMarshalling001, TestSize.Level2)
+{
+    DTEST_LOG << "SystemAbilityOnDemandReasonMarshalling001 start" << std::endl;
+    SystemAbilityOnDemandReason reason(OnDemandReasonId::COMMON_EVENT, REASON_NAME, REASON_VALUE, EXTRA_DATA_ID);
+    Parcel parcel;
+    EXPECT_TRUE(reason.Marshalling(parcel));
+    SystemAbilityOnDemandReason readReason;
+    EXPECT_TRUE(SystemAbilityOnDemandReason::Unmarshalling(parcel, readReason));
+    EXPECT_EQ(readReason.reasonId_, OnDemandReasonId::COMMON_EVENT);
+    EXPECT_EQ(readReason.reasonName_, REASON_NAME);
+    EXPECT_EQ(readReason.reasonValue_, REASON_VALUE);
+    EXPECT_EQ(readReason.extraDataId_, EXTRA_DATA_ID);
+    DTEST_LOG << "SystemAbilityOnDemandReasonMarshalling001 end" << std::endl;
+}
+
+/**
+ * @tc.name: SystemAbilityOnDemandReasonUnmarshalling001
+ * @tc.desc: test Unmarshalling of SystemAbilityOnDemandReason with unknown version and truncated parcel
+ * @tc.type: FUNC
+ */
+HWTEST_F(SystemAbilityOndemandReasonTest, SystemAbilityOnDemandReasonUnmarshalling001, TestSize.Level2)
+{
+    DTEST_LOG << "SystemAbilityOnDemandReasonUnmarshalling001 start" << std::endl;
+    SystemAbilityOnDemandReason reason;
+    Parcel parcel;
+    parcel.WriteInt32(0);
+    EXPECT_FALSE(SystemAbilityOnDemandReason::Unmarshalling(parcel, reason));
+    Parcel truncatedParcel;
+    truncatedParcel.WriteInt32(ONDEMAND_REASON_PARCEL_VERSION);
+    truncatedParcel.WriteInt32(static_cast<int32_t>(OnDemandReasonId::PARAM));
+    EXPECT_FALSE(SystemAbilityOnDemandReason::Unmarshalling(truncatedParcel, reason));
+    EXPECT_EQ(reason.reasonName_, "");
+    DTEST_LOG << "SystemAbilityOnDemandReasonUnmarshalling001 end" << std::endl;
+}
+
+/**
+ * @tc.name: SystemAbilityOnDemandReasonMarshalling002
+ * @tc.desc: test Marshalling and Unmarshalling of SystemAbilityOnDemandReason carrying its extra data inline
+ * @tc.type: FUNC
+ */
+HWTEST_F(SystemAbilityOndemandReasonTest, SystemAbilityOnDemandReasonMarshalling002, TestSize.Level2)
+{
+    DTEST_LOG << "SystemAbilityOnDemandReasonMarshalling002 start" << std::endl;
+    SystemAbilityOnDemandReason reason(OnDemandReasonId::COMMON_EVENT, REASON_NAME, REASON_VALUE, EXTRA_DATA_ID);
+    std::map<std::string, std::string> want = {{"test", "test"}};
+    OnDemandReasonExtraData extraData(CODE, DATA, want);
+    reason.SetExtraData(extraData);
+    Parcel parcel;
+    EXPECT_TRUE(reason.Marshalling(parcel));
+    SystemAbilityOnDemandReason readReason;
+    EXPECT_TRUE(SystemAbilityOnDemandReason::Unmarshalling(parcel, readReason));
+    EXPECT_TRUE(readReason.IsExtraDataLoaded());
+    EXPECT_EQ(readReason.extraDataId_, EXTRA_DATA_ID);
+    EXPECT_EQ(readReason.GetExtraData().GetCode(), CODE);
+    EXPECT_EQ(readReason.GetExtraData().GetData(), DATA);
+    EXPECT_EQ(readReason.GetExtraData().GetWant(), want);
+    DTEST_LOG << "SystemAbilityOnDemandReasonMarshalling002 end" << std::endl;
+}
+
+/**
+ * @tc.name: SystemAbilityOnDemandReasonUnmarshalling002
+ * @tc.desc: test Unmarshalling of SystemAbilityOnDemandReason written with layout version 1
+ * @tc.type: FUNC
+ */
+HWTEST_F(SystemAbilityOndemandReasonTest, SystemAbilityOnDemandReasonUnmarshalling002, TestSize.Level2)
+{
+    DTEST_LOG << "SystemAbilityOnDemandReasonUnmarshalling002 start" << std::endl;
+    Parcel parcel;
+    parcel.WriteInt32(1);
+    parcel.WriteInt32(static_cast<int32_t>(OnDemandReasonId::COMMON_EVENT));
+    parcel.WriteString(REASON_NAME);
+    parcel.WriteString(REASON_VALUE);
+    parcel.WriteInt64(EXTRA_DATA_ID);
+    SystemAbilityOnDemandReason reason;
+    EXPECT_TRUE(SystemAbilityOnDemandReason::Unmarshalling(parcel, reason));
+    EXPECT_EQ(reason.extraDataId_, EXTRA_DATA_ID);
+    EXPECT_FALSE(reason.IsExtraDataLoaded());
+    DTEST_LOG << "SystemAbilityOnDemandReasonUnmarshalling002 end" << std::endl;
+}
+
+/**
+ * @tc.name: SystemAbilityOnDemandReasonUnmarshalling003
+ * @tc.desc: test Unmarshalling of SystemAbilityOnDemandReason, fields of a later version are skipped by size
+ * @tc.type: FUNC
+ */
+HWTEST_F(SystemAbilityOndemandReasonTest, SystemAbilityOnDemandReasonUnmarshalling003, TestSize.Level2)
+{
+    DTEST_LOG << "SystemAbilityOnDemandReasonUnmarshalling003 start" << std::endl;
+    constexpr int32_t nextField = 100;
+    constexpr int32_t sentinel = 200;
+    Parcel fields;
+    fields.WriteInt32(static_cast<int32_t>(OnDemandReasonId::PARAM));
+    fields.WriteString(REASON_NAME);
+    fields.WriteString(REASON_VALUE);
+    fields.WriteInt64(EXTRA_DATA_ID);
+    fields.WriteBool(false);
+    fields.WriteInt32(nextField);
+    Parcel parcel;
+    parcel.WriteInt32(ONDEMAND_REASON_PARCEL_VERSION + 1);
+    parcel.WriteInt32(static_cast<int32_t>(fields.GetDataSize()));
+    parcel.WriteBuffer(reinterpret_cast<const void*>(fields.GetData()), fields.GetDataSize());
+    parcel.WriteInt32(sentinel);
+    SystemAbilityOnDemandReason reason;
+    EXPECT_TRUE(SystemAbilityOnDemandReason::Unmarshalling(parcel, reason));
+    EXPECT_EQ(reason.reasonName_, REASON_NAME);
+    EXPECT_EQ(reason.extraDataId_, EXTRA_DATA_ID);
+    EXPECT_EQ(parcel.ReadInt32(), sentinel);
+    Parcel oversizedParcel;
+    oversizedParcel.WriteInt32(ONDEMAND_REASON_PARCEL_VERSION);
+    oversizedParcel.WriteInt32(static_cast<int32_t>(fields.GetDataSize()) + 1);
+    oversizedParcel.WriteBuffer(reinterpret_cast<const void*>(fields.GetData()), fields.GetDataSize());
+    EXPECT_FALSE(SystemAbilityOnDemandReason::Unmarshalling(oversizedParcel, reason));
+    DTEST_LOG << "SystemAbilityOnDemandReasonUnmarshalling003 end" << std::endl;
+}
+
+/**
+ * @tc.name: OnDemandReasonExtraDataGetWantView001
+ * @tc.desc: test GetWantView, the json want read by Unmarshalling is decoded on first access
+ * @tc.type: FUNC
+ */
+HWTEST_F(SystemAbilityOndemandReasonTest, OnDemandReasonExtraDataGetWantView001, TestSize.Level2)
+{
+    DTEST_LOG << "OnDemandReasonExtraDataGetWantView001 start" << std::endl;
+    std::map<std::string, std::string> want = {{"key1", "value1"}, {"key2", ""}};
+    OnDemandReasonExtraData extraData(CODE, DATA, want);
+    Parcel parcel;
+    EXPECT_TRUE(extraData.Marshalling(parcel));
+    std::unique_ptr<OnDemandReasonExtraData> readData(OnDemandReasonExtraData::Unmarshalling(parcel));
+    ASSERT_NE(readData, nullptr);
+    const auto& view = readData->GetWantView();
+    ASSERT_EQ(view.size(), want.size());
+    EXPECT_EQ(view[0].first, "key1");
+    EXPECT_EQ(view[0].second, "value1");
+    EXPECT_EQ(view[1].first, "key2");
+    EXPECT_EQ(view[1].second, "");
+    EXPECT_EQ(readData->GetWant(), want);
+    DTEST_LOG << "OnDemandReasonExtraDataGetWantView001 end" << std::endl;
+}
+
+/**
+ * @tc.name: OnDemandReasonExtraDataMarshallingCompact001
+ * @tc.desc: test MarshallingCompact and UnmarshallingCompact, lengths not matching the buffer are rejected
+ * @tc.type: FUNC
+ */
+HWTEST_F(SystemAbilityOndemandReasonTest, OnDemandReasonExtraDataMarshallingCompact001, TestSize.Level2)
+{
+    DTEST_LOG << "OnDemandReasonExtraDataMarshallingCompact001 start" << std::endl;
+    std::map<std::string, std::string> want = {{"key", "value"}};
+    OnDemandReasonExtraData extraData(CODE, DATA, want);
+    Parcel parcel;
+    EXPECT_TRUE(extraData.MarshallingCompact(parcel));
+    OnDemandReasonExtraData readData;
+    EXPECT_TRUE(OnDemandReasonExtraData::UnmarshallingCompact(parcel, readData));
+    EXPECT_EQ(readData.GetCode(), CODE);
+    EXPECT_EQ(readData.GetData(), DATA);
+    EXPECT_EQ(readData.GetWant(), want);
+    Parcel invalidParcel;
+    invalidParcel.WriteInt32(CODE);
+    invalidParcel.WriteString(DATA);
+    invalidParcel.WriteString("keyvalue");
+    invalidParcel.WriteUInt32Vector({3, 6});
+    OnDemandReasonExtraData invalidData;
+    EXPECT_FALSE(OnDemandReasonExtraData::UnmarshallingCompact(invalidParcel, invalidData));
+    DTEST_LOG << "OnDemandReasonExtraDataMarshallingCompact001 end" << std::endl;
+}
+}
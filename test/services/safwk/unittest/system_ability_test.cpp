@@ -170,6 +170,24 @@ HWTEST_F(SystemAbilityTest, RemoveSystemAbilityListener001, TestSize.Level0)
     DTEST_LOG << "RemoveSystemAbilityListener001 end" << std::endl;
 }
 
+/**
+ * @tc.name: AddSystemAbilityListeners001
+ * @tc.desc: Check AddSystemAbilityListeners registers every valid SA once
+ * @tc.type: FUNC
+ */
+HWTEST_F(SystemAbilityTest, AddSystemAbilityListeners001, TestSize.Level1)
+{
+    DTEST_LOG << "AddSystemAbilityListeners001 start" << std::endl;
+    std::shared_ptr<SystemAbility> sysAby = std::make_shared<MockSaRealize>(SAID, false);
+    bool res = sysAby->AddSystemAbilityListeners({LISTENER_ID, LISTENER_ID, -1});
+    EXPECT_FALSE(res);
+    auto listenerRecord = LocalAbilityManager::GetInstance().FindListenerRecordLocked(LISTENER_ID);
+    ASSERT_NE(listenerRecord, nullptr);
+    EXPECT_EQ(listenerRecord->listeners.count(SAID), 1);
+    EXPECT_TRUE(sysAby->RemoveSystemAbilityListener(LISTENER_ID));
+    DTEST_LOG << "AddSystemAbilityListeners001 end" << std::endl;
+}
+
 /**
  * @tc.name: MakeAndRegisterAbility001
  * @tc.desc: Check MakeAndRegisterAbility
@@ -564,5 +582,41 @@ HWTEST_F(SystemAbilityTest, GetOnDemandReasonExtraData001, TestSize.Level2)
     EXPECT_TRUE(onDemandStartReason.HasExtraData());
     DTEST_LOG << "GetOnDemandReasonExtraData001 end" << std::endl;
 }
+
+/**
+ * @tc.name: GetOnDemandReasonExtraData002
+ * @tc.desc: Check GetOnDemandReasonExtraData keeps extra data carried inline
+ * @tc.type: FUNC
+ */
+HWTEST_F(SystemAbilityTest, GetOnDemandReasonExtraData002, TestSize.Level2)
+{
+    DTEST_LOG << "GetOnDemandReasonExtraData002 start" << std::endl;
+    std::shared_ptr<SystemAbility> sysAby = std::make_shared<MockSaRealize>(SAID, false);
+    SystemAbilityOnDemandReason onDemandStartReason;
+    onDemandStartReason.reasonId_ = OHOS::OnDemandReasonId::COMMON_EVENT;
+    OnDemandReasonExtraData extraData(1, "data", {});
+    onDemandStartReason.SetExtraData(extraData);
+    sysAby->GetOnDemandReasonExtraData(onDemandStartReason);
+    EXPECT_TRUE(onDemandStartReason.IsExtraDataLoaded());
+    EXPECT_EQ(onDemandStartReason.GetExtraData().GetData(), "data");
+    DTEST_LOG << "GetOnDemandReasonExtraData002 end" << std::endl;
+}
+
+/**
+ * @tc.name: OnExtensionAsync001
+ * @tc.desc: Check OnExtensionAsync runs OnExtension by default
+ * @tc.type: FUNC
+ */
+HWTEST_F(SystemAbilityTest, OnExtensionAsync001, TestSize.Level2)
+{
+    DTEST_LOG << "OnExtensionAsync001 start" << std::endl;
+    std::shared_ptr<SystemAbility> sysAby = std::make_shared<MockSaRealize>(SAID, false);
+    auto extReply = std::make_shared<SystemAbilityExtensionReply>(SAID, "ext", nullptr);
+    MessageParcel data;
+    int32_t ret = sysAby->OnExtensionAsync("ext", data, extReply);
+    EXPECT_EQ(ret, 0);
+    EXPECT_FALSE(extReply->Complete(ret));
+    DTEST_LOG << "OnExtensionAsync001 end" << std::endl;
+}
 }
 }
\ No newline at end of file